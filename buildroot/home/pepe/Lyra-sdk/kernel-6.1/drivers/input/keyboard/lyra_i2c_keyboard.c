@@ -9,15 +9,38 @@
  * - Relative mouse input with configurable speed
  * - Power button support
  * - FIFO-based event queue
+ *
+ * The device is attached either to I2C (polled register map) or to a UART
+ * through serdev, where the firmware pushes the same registers as packets.
  */
 
 #include <linux/module.h>
 #include <linux/i2c.h>
+#include <linux/interrupt.h>
 #include <linux/input.h>
+#include <linux/input/matrix_keypad.h>
+#include <linux/property.h>
+#include <linux/reboot.h>
+#include <linux/power_supply.h>
+#include <linux/pm_runtime.h>
+#include <linux/pm_wakeirq.h>
 #include <linux/slab.h>
 #include <linux/delay.h>
-#include <linux/workqueue.h>
+#include <linux/kthread.h>
+#include <linux/hrtimer.h>
+#include <linux/sched.h>
 #include <linux/of.h>
+#include <linux/crc8.h>
+#include <linux/serdev.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/ktime.h>
+#include <linux/log2.h>
+#include <linux/math64.h>
+#include <asm/unaligned.h>
+
+#define CREATE_TRACE_POINTS
+#include "lyra_i2c_keyboard_trace.h"
 
 /* Register addresses */
 #define REG_KEY_STATUS		0x00
@@ -25,11 +48,84 @@
 #define REG_MOUSE_X		0x02
 #define REG_MOUSE_Y		0x03
 #define REG_INT_STATUS		0x04
+#define REG_GHOST_COUNT		0x05
+#define REG_EVENT_FRAME		0x06
+#define REG_FRAME_REPEAT	0x07
+#define REG_POWER_STATUS	0x08
+#define REG_POWER_CTRL		0x09
+#define REG_ID_BASE		0x10
+#define REG_TELEMETRY_BASE	0x20
+#define REG_BATTERY_BASE	0x30
+
+/* Identification block (offsets from REG_ID_BASE) */
+#define ID_MAGIC0		0x00
+#define ID_MAGIC1		0x01
+#define ID_PROTOCOL_MAJOR	0x02
+#define ID_PROTOCOL_MINOR	0x03
+#define ID_BUILD_HASH		0x04
+#define ID_CAPABILITIES		0x08
+#define ID_BLOCK_LEN		0x0A
+
+#define ID_MAGIC0_VALUE		0x4C	/* 'L' */
+#define ID_MAGIC1_VALUE		0x4B	/* 'K' */
+#define LYRA_PROTOCOL_MAJOR	1
+
+/* Capability bits */
+#define CAP_BURST_READ		BIT(0)
+#define CAP_WIDE_EVENTS		BIT(1)
+#define CAP_TIMESTAMPS		BIT(2)
+#define CAP_IRQ_MODERATION	BIT(3)
+#define CAP_CONFIG_PAGE		BIT(4)
+#define CAP_EVENT_FRAMES	BIT(5)
+#define CAP_TELEMETRY		BIT(6)
+#define CAP_POWER_STATUS	BIT(7)
+#define CAP_SHUTDOWN		BIT(8)
+#define CAP_BATTERY		BIT(9)
+#define CAP_LOW_POWER		BIT(10)
+
+/* Battery block (offsets from REG_BATTERY_BASE) */
+#define BATTERY_VOLTAGE		0x00	/* le16, mV */
+#define BATTERY_PERCENT		0x02
+#define BATTERY_FLAGS		0x03
+#define BATTERY_BLOCK_LEN	0x08
+
+#define BATTERY_FLAG_VALID	BIT(0)
+#define BATTERY_FLAG_PRESENT	BIT(1)
+#define BATTERY_FLAG_LOW	BIT(2)
+
+/*
+ * Event frame: [seq][count][events...][crc8], CRC-8 poly 0x07. With
+ * CAP_TIMESTAMPS it is followed by [age 0..7][crc8]: the age of each event
+ * in ms when the frame was built, and a CRC over all bytes before it.
+ */
+#define FRAME_MAX_EVENTS	8
+#define FRAME_BASE_SIZE		(2 + FRAME_MAX_EVENTS + 1)
+#define FRAME_AGES		FRAME_BASE_SIZE
+#define FRAME_SIZE		(FRAME_BASE_SIZE + FRAME_MAX_EVENTS + 1)
+#define FRAME_CRC8_POLY		0x07
+#define FRAME_RETRIES		2
+
+/*
+ * UART transport packets: [sync][type][seq][len][payload][crc8],
+ * CRC-8 over type, seq, len and payload.
+ */
+#define UART_SYNC_BYTE		0xA5
+#define UART_MAX_PAYLOAD	40
+#define UART_PKT_REPORT		0x01	/* status, int, mouse x/y, ghosts, events */
+#define UART_PKT_ID		0x02	/* identification block */
+#define UART_PKT_REGISTER	0x03
+#define UART_CMD_IDENTIFY	0x81
+#define UART_CMD_READ_REG	0x82	/* [register], answered with UART_PKT_REGISTER */
+#define UART_CMD_WRITE_REG	0x83	/* [register][value...] */
+#define UART_REPORT_HEADER_LEN	5
+#define LYRA_UART_BAUDRATE	1500000
 
 /* Register bit definitions */
-#define KEY_STATUS_SHIFT_BIT	BIT(0)
+#define KEY_STATUS_FN_BIT	BIT(0)
 #define KEY_STATUS_ALT_BIT	BIT(1)
-#define KEY_STATUS_FN_BIT	BIT(2)
+#define KEY_STATUS_SHIFT_BIT	BIT(2)
+#define KEY_STATUS_MOD_MASK	0x07
+#define KEY_STATUS_ROLLOVER_BIT	BIT(3)
 #define KEY_STATUS_FIFO_MASK	0xF0
 #define KEY_STATUS_FIFO_SHIFT	4
 
@@ -48,19 +144,114 @@
 #define INT_STATUS_KEY_EVENT		BIT(4)
 #define INT_STATUS_MOUSE_EVENT		BIT(5)
 #define INT_STATUS_POWER_BTN		BIT(6)
+#define INT_STATUS_FIFO_WATERMARK	BIT(7)
+
+/* Power status: level and latch are live, press events clear on read */
+#define POWER_STATUS_BUTTON		BIT(0)
+#define POWER_STATUS_PRESSED		BIT(1)
+#define POWER_STATUS_SHORT_PRESS	BIT(2)
+#define POWER_STATUS_LONG_PRESS		BIT(3)
+#define POWER_STATUS_LATCH		BIT(4)
+#define POWER_STATUS_SHUTDOWN		BIT(5)
+#define POWER_STATUS_SLEEP		BIT(6)
+
+/* Power control: the host is ready to lose power, release the latch */
+#define POWER_CMD_OFF			0x01
+#define POWER_CMD_SLEEP			0x02	/* Once every event has been read */
+#define POWER_CMD_WAKE			0x03
+#define POWER_OFF_TIMEOUT_MS		100
+
+/* Runtime PM: put the firmware to sleep after this long without events */
+#define LYRA_AUTOSUSPEND_MS		5000
 
 #define MAX_KEYCODES		53
-#define POLL_INTERVAL_MS	10
+
+/*
+ * Keymap table: [layer][code], indexed by the scan code
+ * (layer << KEYMAP_LAYER_SHIFT) | code. The code field of a FIFO event is
+ * six bits wide, so every layer has room for 64 codes.
+ */
+#define KEYMAP_LAYER_SHIFT	6
+#define KEYMAP_CODES		BIT(KEYMAP_LAYER_SHIFT)
+#define KEYMAP_LAYERS		3
+#define KEYMAP_SIZE		(KEYMAP_LAYERS * KEYMAP_CODES)
+
+enum lyra_kbd_layer {
+	LYRA_LAYER_NORMAL,
+	LYRA_LAYER_SHIFT,
+	LYRA_LAYER_FN,
+};
+
 #define FIFO_MAX_READ		16
 
+/*
+ * Adaptive polling: poll every POLL_ACTIVE_MS while the device reports
+ * activity and for POLL_HOLD_MS after it, then double the interval on
+ * every idle poll up to POLL_INTERVAL_MS.
+ */
+#define POLL_ACTIVE_MS		3
+#define POLL_HOLD_MS		500
+#define POLL_INTERVAL_MS	100
+
+/* Firmware typematic defaults (TYPEMATIC_DELAY_MS/INTERVAL_MS in config.h) */
+#define LYRA_REP_DELAY_MS	500
+#define LYRA_REP_PERIOD_MS	33
+
+/* Drain latency histogram: bucket 0 is 0us, bucket n covers [2^(n-1), 2^n) us */
+#define LATENCY_BUCKETS		16
+
+/* Bus and drain statistics, exported through debugfs */
+struct lyra_kbd_stats {
+	ktime_t since;			/* Probe or last reset */
+	u64 transfers;			/* I2C transfers issued */
+	u64 bytes;			/* I2C register and data bytes, or UART bytes received */
+	u64 errors;			/* Failed transfers */
+	u64 crc_errors;			/* Event frames or UART packets failing the CRC */
+	u64 fifo_overflows;
+	u64 frames_lost;
+	u64 events;
+	u64 drains;
+	u64 drain_events[FIFO_MAX_READ + 1];
+	u64 latency[LATENCY_BUCKETS];	/* Poll or packet start to input_sync */
+	u32 latency_max_us;
+};
+
+enum lyra_kbd_rx_state {
+	LYRA_RX_WAIT_SYNC,
+	LYRA_RX_HEADER,
+	LYRA_RX_PAYLOAD,
+	LYRA_RX_CRC,
+};
+
 struct lyra_kbd_data {
-	struct i2c_client *client;
+	struct device *dev;
+	struct i2c_client *client;	/* I2C transport */
+	struct serdev_device *serdev;	/* UART transport */
 	struct input_dev *kbd_input;
 	struct input_dev *mouse_input;
-	struct delayed_work poll_work;
 	
-	/* Track last pressed key for each keycode to ensure proper release */
+	/*
+	 * Polling runs on a dedicated SCHED_FIFO worker, woken by an hrtimer,
+	 * so neither jiffy granularity nor a busy system workqueue adds latency
+	 */
+	struct kthread_worker *poll_worker;
+	struct kthread_work poll_work;
+	struct hrtimer poll_timer;
+	bool polling;
+	
+	/*
+	 * Firmware sleep while the host suspends (CAP_LOW_POWER), and
+	 * autosuspend when its interrupt line can wake us again
+	 */
+	bool low_power;
+	bool autosuspend;
+	
+	/* Active keymap, remappable through EVIOCSKEYCODE */
+	unsigned short keymap[KEYMAP_SIZE];
+	
+	/* Track last pressed key and its scan code to ensure proper release */
 	unsigned short last_key_pressed[MAX_KEYCODES];
+	u8 last_scancode[MAX_KEYCODES];
 	
 	/* Mouse speed multiplier (percentage: 100 = 1x, 200 = 2x) */
 	int mouse_speed_x;
@@ -68,13 +259,60 @@ struct lyra_kbd_data {
 	
 	/* Power button state */
 	bool power_btn_pressed;
+	bool shutdown_requested;
+	
+	/* Adaptive polling curve (see POLL_ACTIVE_MS) and its current state */
+	unsigned int poll_active_ms;
+	unsigned int poll_hold_ms;
+	unsigned int poll_interval_ms;	/* Idle interval, the slowest rate */
+	unsigned int poll_current_ms;
+	unsigned long last_activity;	/* jiffies of the last non-zero INT status */
+	
+	/* Firmware identification (all zero for legacy firmware) */
+	u8 proto_major;
+	u8 proto_minor;
+	u32 build_hash;
+	u16 caps;
+	
+	/* Framed event mode state */
+	bool use_frames;
+	bool use_timestamps;		/* Frames carry event ages */
+	
+	/* FIFO mode: key status and FIFO read in one combined transfer */
+	bool use_fifo_batch;
+	bool frame_seq_valid;
+	u8 last_frame_seq;
+	
+	/*
+	 * Key status the current batch of events is translated with: pushed
+	 * with each UART report, or read once per FIFO drain over I2C
+	 */
+	u8 key_status;
+	
+	/* UART transport packet parser */
+	enum lyra_kbd_rx_state rx_state;
+	u8 rx_buf[3 + UART_MAX_PAYLOAD];
+	u8 rx_pos;
 	
-	/* Polling interval */
-	unsigned int poll_interval_ms;
+	struct lyra_kbd_stats stats;
+	struct dentry *debugfs;
+	
+	/* Battery monitored by the firmware ADC */
+	struct power_supply *battery;
+	struct power_supply_desc battery_desc;
 };
 
-/* Static keymap based on keyboard_layout.json */
-/* Index = keycode (0-52), value = Linux key code */
+static struct dentry *lyra_kbd_debugfs_root;
+
+DECLARE_CRC8_TABLE(lyra_kbd_crc8_table);
+
+/*
+ * Default keymap based on keyboard_layout.json, copied into the per-device
+ * [layer][code] table at probe. Index = keycode (0-52), value = Linux key
+ * code. SHIFT, ALT and FN are latched by the firmware and reported from the
+ * key status register, so their own events map to KEY_RESERVED, as does
+ * RSHIFT, which the firmware does not treat as a modifier.
+ */
 
 /* Normal layer (no modifiers) */
 static const unsigned short keymap_normal[MAX_KEYCODES] = {
@@ -103,23 +341,23 @@ static const unsigned short keymap_normal[MAX_KEYCODES] = {
 	KEY_E,		/* 22: B4 */
 	KEY_C,		/* 23: C4 */
 	KEY_D,		/* 24: D4 */
-	KEY_LEFTSHIFT,	/* 25: E4 */
+	KEY_RESERVED,	/* 25: E4 - LSHIFT, from key status */
 	KEY_M,		/* 26: F4 */
 	KEY_SPACE,	/* 27: G4 - SPACEBAR */
 	KEY_2,		/* 28: A5 */
 	KEY_ESC,	/* 29: B5 */
-	KEY_LEFTALT,	/* 30: C5 */
+	KEY_RESERVED,	/* 30: C5 - ALT, from key status */
 	KEY_TAB,	/* 31: D5 */
 	KEY_V,		/* 32: E5 */
 	KEY_LEFTCTRL,	/* 33: F5 */
 	KEY_BACKSPACE,	/* 34: G5 */
 	KEY_1,		/* 35: A6 */
 	KEY_Q,		/* 36: B6 */
-	KEY_FN,		/* 37: C6 */
+	KEY_RESERVED,	/* 37: C6 - FN, from key status */
 	KEY_Z,		/* 38: D6 */
 	KEY_B,		/* 39: E6 */
 	KEY_N,		/* 40: F6 */
-	KEY_RIGHTSHIFT,	/* 41: G6 */
+	KEY_RESERVED,	/* 41: G6 - RSHIFT, unmapped */
 	KEY_W,		/* 42: FN1 */
 	KEY_A,		/* 43: FN2 */
 	KEY_S,		/* 44: FN3 */
@@ -160,23 +398,23 @@ static const unsigned short keymap_shift[MAX_KEYCODES] = {
 	KEY_E,		/* 22: E */
 	KEY_C,		/* 23: C */
 	KEY_D,		/* 24: D */
-	KEY_LEFTSHIFT,	/* 25: LSHIFT */
+	KEY_RESERVED,	/* 25: LSHIFT, from key status */
 	KEY_M,		/* 26: M */
 	KEY_SPACE,	/* 27: SPACEBAR */
 	KEY_2,		/* 28: @ (shift+2) */
 	KEY_ESC,	/* 29: ESC */
-	KEY_LEFTALT,	/* 30: ALT */
+	KEY_RESERVED,	/* 30: ALT, from key status */
 	KEY_TAB,	/* 31: TAB */
 	KEY_V,		/* 32: V */
 	KEY_LEFTCTRL,	/* 33: CTRL */
 	KEY_BACKSPACE,	/* 34: BACKSPACE */
 	KEY_1,		/* 35: ! (shift+1) */
 	KEY_Q,		/* 36: Q */
-	KEY_FN,		/* 37: FN */
+	KEY_RESERVED,	/* 37: FN, from key status */
 	KEY_Z,		/* 38: Z */
 	KEY_B,		/* 39: B */
 	KEY_N,		/* 40: N */
-	KEY_RIGHTSHIFT,	/* 41: RSHIFT */
+	KEY_RESERVED,	/* 41: RSHIFT, unmapped */
 	KEY_W,		/* 42: W */
 	KEY_A,		/* 43: A */
 	KEY_S,		/* 44: S */
@@ -217,23 +455,23 @@ static const unsigned short keymap_fn[MAX_KEYCODES] = {
 	KEY_GRAVE,	/* 22: ` */
 	KEY_SEMICOLON,	/* 23: ; */
 	KEY_SEMICOLON,	/* 24: : (shift+;) */
-	KEY_LEFTSHIFT,	/* 25: LSHIFT */
+	KEY_RESERVED,	/* 25: LSHIFT, from key status */
 	KEY_SLASH,	/* 26: ? (shift+/) */
 	KEY_SPACE,	/* 27: SPACEBAR */
 	KEY_F2,		/* 28: F2 */
 	KEY_ESC,	/* 29: ESC */
-	KEY_LEFTALT,	/* 30: ALT */
+	KEY_RESERVED,	/* 30: ALT, from key status */
 	KEY_TAB,	/* 31: TAB */
 	KEY_APOSTROPHE,	/* 32: ' */
 	KEY_LEFTCTRL,	/* 33: CTRL */
 	KEY_BACKSPACE,	/* 34: BACKSPACE */
 	KEY_F1,		/* 35: F1 */
 	KEY_GRAVE,	/* 36: ~ (shift+`) */
-	KEY_FN,		/* 37: FN */
+	KEY_RESERVED,	/* 37: FN, from key status */
 	KEY_102ND,	/* 38: | */
 	KEY_LEFTBRACE,	/* 39: [ */
 	KEY_RIGHTBRACE,	/* 40: ] */
-	KEY_RIGHTSHIFT,	/* 41: RSHIFT */
+	KEY_RESERVED,	/* 41: RSHIFT, unmapped */
 	KEY_UP,		/* 42: FN1+FN = UP */
 	KEY_LEFT,	/* 43: FN2+FN = LEFT */
 	KEY_RIGHT,	/* 44: FN3+FN = RIGHT */
@@ -247,184 +485,461 @@ static const unsigned short keymap_fn[MAX_KEYCODES] = {
 	KEY_LEFT,	/* 52: FN12+FN = LEFT */
 };
 
-static int lyra_kbd_read_reg(struct i2c_client *client, u8 reg)
+/* Layer selected by the key status modifier bits: FN wins, ALT has no layer */
+static const u8 lyra_kbd_mod_layer[KEY_STATUS_MOD_MASK + 1] = {
+	[KEY_STATUS_SHIFT_BIT]				= LYRA_LAYER_SHIFT,
+	[KEY_STATUS_SHIFT_BIT | KEY_STATUS_ALT_BIT]	= LYRA_LAYER_SHIFT,
+	[KEY_STATUS_FN_BIT]				= LYRA_LAYER_FN,
+	[KEY_STATUS_FN_BIT | KEY_STATUS_ALT_BIT]	= LYRA_LAYER_FN,
+	[KEY_STATUS_FN_BIT | KEY_STATUS_SHIFT_BIT]	= LYRA_LAYER_FN,
+	[KEY_STATUS_MOD_MASK]				= LYRA_LAYER_FN,
+};
+
+/* Account one transfer moving len register and data bytes */
+static void lyra_kbd_count_transfer(struct lyra_kbd_data *kbd, int ret, unsigned int len)
+{
+	kbd->stats.transfers++;
+	if (ret < 0)
+		kbd->stats.errors++;
+	else
+		kbd->stats.bytes += len;
+}
+
+/* Account one drain of n events that started at start */
+static void lyra_kbd_count_drain(struct lyra_kbd_data *kbd, int n, ktime_t start)
+{
+	struct lyra_kbd_stats *stats = &kbd->stats;
+	s64 us;
+	
+	stats->drains++;
+	stats->events += n;
+	stats->drain_events[min(n, FIFO_MAX_READ)]++;
+	
+	if (n == 0)
+		return;
+	
+	us = ktime_us_delta(ktime_get(), start);
+	if (us < 0)
+		us = 0;
+	stats->latency[us ? min_t(int, ilog2(us) + 1, LATENCY_BUCKETS - 1) : 0]++;
+	if (us > stats->latency_max_us)
+		stats->latency_max_us = min_t(s64, us, U32_MAX);
+}
+
+static int lyra_kbd_read_reg(struct lyra_kbd_data *kbd, u8 reg)
 {
 	int ret;
 	
-	ret = i2c_smbus_read_byte_data(client, reg);
-	if (ret < 0)
-		dev_err(&client->dev, "Failed to read reg 0x%02x: %d\n", reg, ret);
+	ret = i2c_smbus_read_byte_data(kbd->client, reg);
+	lyra_kbd_count_transfer(kbd, ret, 2);
+	if (ret < 0) {
+		trace_lyra_kbd_i2c_error(kbd->dev, reg, ret);
+		dev_err_ratelimited(kbd->dev, "Failed to read reg 0x%02x: %d\n",
+				    reg, ret);
+	}
 	
 	return ret;
 }
 
-static void lyra_kbd_process_key_event(struct lyra_kbd_data *kbd, u8 keycode, 
-					bool pressed)
+static int lyra_kbd_write_reg(struct lyra_kbd_data *kbd, u8 reg, u8 value)
 {
-	unsigned short key;
 	int ret;
-	u8 key_status;
-	bool shift, alt, fn;
 	
-	if (keycode >= MAX_KEYCODES) {
-		dev_warn(&kbd->client->dev, "Invalid keycode: %d\n", keycode);
-		return;
+	ret = i2c_smbus_write_byte_data(kbd->client, reg, value);
+	lyra_kbd_count_transfer(kbd, ret, 2);
+	if (ret < 0) {
+		trace_lyra_kbd_i2c_error(kbd->dev, reg, ret);
+		dev_err_ratelimited(kbd->dev, "Failed to write reg 0x%02x: %d\n",
+				    reg, ret);
 	}
 	
-	/* Read current modifier state from hardware */
-	ret = lyra_kbd_read_reg(kbd->client, REG_KEY_STATUS);
-	if (ret < 0)
-		return;
-	
-	key_status = (u8)ret;
-	shift = (key_status & KEY_STATUS_SHIFT_BIT) != 0;
-	alt = (key_status & KEY_STATUS_ALT_BIT) != 0;
-	fn = (key_status & KEY_STATUS_FN_BIT) != 0;
+	return ret;
+}
+
+#if IS_ENABLED(CONFIG_SERIAL_DEV_BUS)
+/* Ask for one register; the firmware answers with a UART_PKT_REGISTER */
+static void lyra_kbd_serdev_read_reg(struct lyra_kbd_data *kbd, u8 reg)
+{
+	u8 packet[6] = { UART_SYNC_BYTE, UART_CMD_READ_REG, 0, 1, reg };
 	
-	/* Debug logging */
-	dev_info(&kbd->client->dev, "Key event: code=%d pressed=%d shift=%d alt=%d fn=%d\n",
-		 keycode, pressed, shift, alt, fn);
+	packet[5] = crc8(lyra_kbd_crc8_table, &packet[1], 4, 0);
+	serdev_device_write_buf(kbd->serdev, packet, sizeof(packet));
+}
+
+static void lyra_kbd_serdev_write_reg(struct lyra_kbd_data *kbd, u8 reg, u8 value)
+{
+	u8 packet[7] = { UART_SYNC_BYTE, UART_CMD_WRITE_REG, 0, 2, reg, value };
 	
-	/* Handle modifier keys - report them directly */
-	if (keycode == 25 || keycode == 41) { /* LSHIFT/RSHIFT */
-		/* Shift is handled via REG_KEY_STATUS in lyra_kbd_sync_modifiers */
+	packet[6] = crc8(lyra_kbd_crc8_table, &packet[1], 5, 0);
+	serdev_device_write_buf(kbd->serdev, packet, sizeof(packet));
+}
+#endif
+
+/*
+ * Read the identification block. Firmware without it returns 0x00 for
+ * unknown registers, so a magic mismatch means legacy firmware and no
+ * optional features are used.
+ */
+static void lyra_kbd_apply_id(struct lyra_kbd_data *kbd, const u8 *id)
+{
+	if (id[ID_PROTOCOL_MAJOR] != LYRA_PROTOCOL_MAJOR) {
+		dev_warn(kbd->dev, "Unsupported protocol %u.%u, using legacy mode\n",
+			 id[ID_PROTOCOL_MAJOR], id[ID_PROTOCOL_MINOR]);
 		return;
 	}
 	
-	if (keycode == 30) { /* ALT key */
-		/* Alt is handled via REG_KEY_STATUS in lyra_kbd_sync_modifiers */
-		return;
+	kbd->proto_major = id[ID_PROTOCOL_MAJOR];
+	kbd->proto_minor = id[ID_PROTOCOL_MINOR];
+	kbd->build_hash = get_unaligned_le32(&id[ID_BUILD_HASH]);
+	kbd->caps = get_unaligned_le16(&id[ID_CAPABILITIES]);
+	
+	dev_info(kbd->dev, "Firmware protocol %u.%u build %08x caps 0x%04x\n",
+		 kbd->proto_major, kbd->proto_minor, kbd->build_hash, kbd->caps);
+}
+
+/*
+ * Current firmware serves the block from one staged DMA transfer, so read
+ * it in one go. Byte reads are the fallback for adapters without I2C block
+ * reads.
+ */
+static void lyra_kbd_probe_caps(struct lyra_kbd_data *kbd)
+{
+	bool block = i2c_check_functionality(kbd->client->adapter,
+					     I2C_FUNC_SMBUS_READ_I2C_BLOCK);
+	u8 id[ID_BLOCK_LEN];
+	int i, ret;
+	
+	kbd->proto_major = 0;
+	kbd->proto_minor = 0;
+	kbd->build_hash = 0;
+	kbd->caps = 0;
+	
+	if (block) {
+		ret = i2c_smbus_read_i2c_block_data(kbd->client, REG_ID_BASE,
+						    ID_BLOCK_LEN, id);
+		if (ret != ID_BLOCK_LEN)
+			return;
 	}
 	
-	if (keycode == 33) { /* CTRL key */
-		input_report_key(kbd->kbd_input, KEY_LEFTCTRL, pressed);
-		input_sync(kbd->kbd_input);
-		return;
+	for (i = 0; i < ID_BLOCK_LEN; i++) {
+		if (!block) {
+			ret = i2c_smbus_read_byte_data(kbd->client, REG_ID_BASE + i);
+			if (ret < 0)
+				return;
+			id[i] = (u8)ret;
+		}
+		
+		/* Stop at the magic on legacy firmware */
+		if (i == ID_MAGIC1 &&
+		    (id[ID_MAGIC0] != ID_MAGIC0_VALUE || id[ID_MAGIC1] != ID_MAGIC1_VALUE)) {
+			dev_info(kbd->dev, "Legacy firmware (no identification registers)\n");
+			return;
+		}
 	}
 	
-	if (keycode == 37) { /* FN key - modifier only, don't report */
+	lyra_kbd_apply_id(kbd, id);
+}
+
+/* Key status: read over I2C, or the value last pushed over UART */
+static int lyra_kbd_get_key_status(struct lyra_kbd_data *kbd)
+{
+	int ret;
+	
+	if (kbd->serdev)
+		return kbd->key_status;
+	
+	ret = lyra_kbd_read_reg(kbd, REG_KEY_STATUS);
+	if (ret >= 0)
+		kbd->key_status = (u8)ret;
+	
+	return ret;
+}
+
+static void lyra_kbd_process_key_event(struct lyra_kbd_data *kbd, u8 keycode, 
+					bool pressed)
+{
+	unsigned short key;
+	u8 key_status, scancode;
+	
+	if (keycode >= MAX_KEYCODES) {
+		dev_warn_ratelimited(kbd->dev, "Invalid keycode: %d\n", keycode);
 		return;
 	}
 	
+	/* Modifier state fetched with this batch of events selects the layer */
+	key_status = kbd->key_status;
+	scancode = (lyra_kbd_mod_layer[key_status & KEY_STATUS_MOD_MASK] <<
+		    KEYMAP_LAYER_SHIFT) | keycode;
+	
 	if (pressed) {
-		/* Select keymap based on modifiers */
-		if (fn)
-			key = keymap_fn[keycode];
-		else if (shift)
-			key = keymap_shift[keycode];
-		else
-			key = keymap_normal[keycode];
-		
-		/* Debug: what key are we reporting? */
-		dev_info(&kbd->client->dev, "  -> Reporting linux_keycode=%d\n", key);
+		key = kbd->keymap[scancode];
+		if (key == KEY_RESERVED)
+			return;
 		
 		/* Store which key we pressed so we can release the same one */
 		kbd->last_key_pressed[keycode] = key;
-		dev_info(&kbd->client->dev, "  -> input_report_key(dev, %d, 1)\n", key);
-		input_event(kbd->kbd_input, EV_MSC, MSC_SCAN, keycode);
-		input_report_key(kbd->kbd_input, key, true);
+		kbd->last_scancode[keycode] = scancode;
 	} else {
 		/* On release, use the same key that was pressed to avoid mismatch */
 		key = kbd->last_key_pressed[keycode];
-		dev_info(&kbd->client->dev, "  -> Lookup last_key_pressed[%d] = %d\n", keycode, key);
-		if (key == 0) {
-			/* If we don't have a record, use current state (shouldn't happen) */
-			if (fn)
-				key = keymap_fn[keycode];
-			else if (shift)
-				key = keymap_shift[keycode];
-			else
-				key = keymap_normal[keycode];
+		if (key == KEY_RESERVED) {
+			/* No record (press lost): fall back to the current layer */
+			key = kbd->keymap[scancode];
+			if (key == KEY_RESERVED)
+				return;
+		} else {
+			scancode = kbd->last_scancode[keycode];
 		}
-		
-		dev_info(&kbd->client->dev, "  -> Releasing linux_keycode=%d\n", key);
-		
-		dev_info(&kbd->client->dev, "  -> input_report_key(dev, %d, 0)\n", key);
-		input_event(kbd->kbd_input, EV_MSC, MSC_SCAN, keycode);
-		input_report_key(kbd->kbd_input, key, false);
-		kbd->last_key_pressed[keycode] = 0;
+		kbd->last_key_pressed[keycode] = KEY_RESERVED;
 	}
 	
-	input_sync(kbd->kbd_input);
-	dev_info(&kbd->client->dev, "  -> input_sync() called\n");
+	input_event(kbd->kbd_input, EV_MSC, MSC_SCAN, scancode);
+	input_report_key(kbd->kbd_input, key, pressed);
+	trace_lyra_kbd_key(kbd->dev, keycode, pressed, key_status, key);
+}
+
+static void lyra_kbd_process_key_repeat(struct lyra_kbd_data *kbd, u8 keycode)
+{
+	unsigned short key;
+
+	if (keycode >= MAX_KEYCODES)
+		return;
+
+	/*
+	 * Firmware repeats are only forwarded for keys we reported as pressed,
+	 * so a lost press or release can never leave a key stuck down.
+	 * Modifiers are never recorded in last_key_pressed and mouse buttons
+	 * do not autorepeat.
+	 */
+	key = kbd->last_key_pressed[keycode];
+	if (key == 0 || (key >= BTN_MISC && key < KEY_OK))
+		return;
+
+	trace_lyra_kbd_key(kbd->dev, keycode, 2, 0, key);
+	input_event(kbd->kbd_input, EV_KEY, key, 2);
+}
+
+/*
+ * Report one FIFO event to the keyboard input device. The caller issues a
+ * single input_sync() for the whole batch.
+ */
+static void lyra_kbd_dispatch_event(struct lyra_kbd_data *kbd, u8 fifo_data)
+{
+	u8 event_type = fifo_data & FIFO_EVENT_TYPE_MASK;
+	u8 keycode = (fifo_data & FIFO_KEYCODE_MASK) >> FIFO_KEYCODE_SHIFT;
+	
+	switch (event_type) {
+	case FIFO_EVENT_PRESS:
+		lyra_kbd_process_key_event(kbd, keycode, true);
+		break;
+	case FIFO_EVENT_RELEASE:
+		lyra_kbd_process_key_event(kbd, keycode, false);
+		break;
+	case FIFO_EVENT_HOLD:
+		/*
+		 * HOLD events are the firmware typematic repeats;
+		 * report them as autorepeat (EV_KEY value 2).
+		 */
+		lyra_kbd_process_key_repeat(kbd, keycode);
+		break;
+	default:
+		dev_warn_ratelimited(kbd->dev, "Unknown event type: %d (raw=0x%02x)\n",
+				     event_type, fifo_data);
+		break;
+	}
 }
 
-static void lyra_kbd_process_fifo(struct lyra_kbd_data *kbd)
+/*
+ * Read the key status and up to FIFO_MAX_READ events in one combined
+ * transfer. Burst-capable firmware pops one event per byte read from the
+ * FIFO register and returns FIFO_EVENT_NONE once it is empty.
+ */
+static int lyra_kbd_read_fifo_batch(struct lyra_kbd_data *kbd, u8 *events)
 {
-	int i = 0, ret;
-	u8 fifo_data;
-	u8 event_type, keycode;
-	bool pressed;
+	struct i2c_client *client = kbd->client;
+	u8 status_reg = REG_KEY_STATUS;
+	u8 fifo_reg = REG_FIFO_ACCESS;
+	u8 key_status;
+	struct i2c_msg msgs[] = {
+		{ .addr = client->addr, .len = 1, .buf = &status_reg },
+		{ .addr = client->addr, .flags = I2C_M_RD, .len = 1, .buf = &key_status },
+		{ .addr = client->addr, .len = 1, .buf = &fifo_reg },
+		{ .addr = client->addr, .flags = I2C_M_RD, .len = FIFO_MAX_READ, .buf = events },
+	};
+	int ret;
 	
-	dev_info(&kbd->client->dev, "Processing FIFO cycle start\n");
+	ret = i2c_transfer(client->adapter, msgs, ARRAY_SIZE(msgs));
+	if (ret >= 0 && ret != ARRAY_SIZE(msgs))
+		ret = -EIO;
+	lyra_kbd_count_transfer(kbd, ret, 3 + FIFO_MAX_READ);
+	if (ret < 0) {
+		trace_lyra_kbd_i2c_error(kbd->dev, REG_FIFO_ACCESS, ret);
+		dev_err_ratelimited(kbd->dev, "FIFO batch read failed: %d\n", ret);
+		return ret;
+	}
+	
+	kbd->key_status = key_status;
+	return FIFO_MAX_READ;
+}
+
+/* Returns the number of events reported */
+static int lyra_kbd_process_fifo(struct lyra_kbd_data *kbd)
+{
+	u8 events[FIFO_MAX_READ];
+	int i, n = 0, ret;
 	
-	/* Drain FIFO until hardware reports no more events or safety limit hit */
-	while (i < FIFO_MAX_READ) {
-		ret = lyra_kbd_read_reg(kbd->client, REG_FIFO_ACCESS);
+	if (kbd->use_fifo_batch) {
+		ret = lyra_kbd_read_fifo_batch(kbd, events);
 		if (ret < 0)
-			return;
+			return 0;
 		
-		fifo_data = (u8)ret;
-		event_type = fifo_data & FIFO_EVENT_TYPE_MASK;
-		keycode = (fifo_data & FIFO_KEYCODE_MASK) >> FIFO_KEYCODE_SHIFT;
+		/*
+		 * An event queued while the read was in progress can follow an
+		 * empty byte, so look at every byte rather than stop at the first
+		 */
+		for (i = 0; i < ret; i++) {
+			if ((events[i] & FIFO_EVENT_TYPE_MASK) == FIFO_EVENT_NONE)
+				continue;
+			trace_lyra_kbd_fifo_read(kbd->dev, REG_FIFO_ACCESS, n++, events[i]);
+			lyra_kbd_dispatch_event(kbd, events[i]);
+		}
+	} else {
+		if (lyra_kbd_get_key_status(kbd) < 0)
+			return 0;
 		
-		/* event_type == FIFO_EVENT_NONE means FIFO empty */
-		if (event_type == FIFO_EVENT_NONE)
+		/* Drain FIFO until hardware reports no more events or safety limit hit */
+		while (n < FIFO_MAX_READ) {
+			ret = lyra_kbd_read_reg(kbd, REG_FIFO_ACCESS);
+			if (ret < 0)
+				break;
+			
+			/* event_type == FIFO_EVENT_NONE means FIFO empty */
+			if ((ret & FIFO_EVENT_TYPE_MASK) == FIFO_EVENT_NONE)
+				break;
+			
+			trace_lyra_kbd_fifo_read(kbd->dev, REG_FIFO_ACCESS, n++, (u8)ret);
+			lyra_kbd_dispatch_event(kbd, (u8)ret);
+		}
+	}
+	
+	if (n > 0)
+		input_sync(kbd->kbd_input);
+	
+	return n;
+}
+
+/*
+ * Read one event frame and verify it.
+ * Returns the number of events in the frame or a negative error code.
+ */
+static int lyra_kbd_read_frame(struct lyra_kbd_data *kbd, u8 reg, u8 *frame)
+{
+	u8 size = kbd->use_timestamps ? FRAME_SIZE : FRAME_BASE_SIZE;
+	int ret;
+	u8 count;
+	
+	ret = i2c_smbus_read_i2c_block_data(kbd->client, reg, size, frame);
+	if (ret >= 0 && ret != size)
+		ret = -EIO;
+	lyra_kbd_count_transfer(kbd, ret, 1 + size);
+	if (ret < 0) {
+		trace_lyra_kbd_i2c_error(kbd->dev, reg, ret);
+		return ret;
+	}
+	
+	count = frame[1];
+	if (count > FRAME_MAX_EVENTS ||
+	    crc8(lyra_kbd_crc8_table, frame, 2 + count, 0) != frame[2 + count] ||
+	    (kbd->use_timestamps &&
+	     crc8(lyra_kbd_crc8_table, frame, FRAME_SIZE - 1, 0) != frame[FRAME_SIZE - 1])) {
+		kbd->stats.crc_errors++;
+		return -EBADMSG;
+	}
+	
+	return count;
+}
+
+/*
+ * Framed event mode: every frame is CRC-checked, and a corrupted or
+ * failed transfer is recovered by re-reading the retained frame, so no
+ * event is lost or misread at higher bus speeds.
+ */
+static int lyra_kbd_process_frames(struct lyra_kbd_data *kbd)
+{
+	u8 frame[FRAME_SIZE];
+	int i, n, ret, retry, events = 0;
+	ktime_t built;
+	u8 seq, lost;
+	
+	/*
+	 * One key status read serves every frame of this drain. It comes
+	 * first: a frame popped before a failed status read would be lost
+	 * without a gap in the sequence numbers.
+	 */
+	if (lyra_kbd_get_key_status(kbd) < 0)
+		return 0;
+	
+	for (n = 0; n < FIFO_MAX_READ / FRAME_MAX_EVENTS; n++) {
+		/* The firmware builds the frame as the read starts */
+		built = ktime_get();
+		ret = lyra_kbd_read_frame(kbd, REG_EVENT_FRAME, frame);
+		for (retry = 0; ret < 0 && retry < FRAME_RETRIES; retry++)
+			ret = lyra_kbd_read_frame(kbd, REG_FRAME_REPEAT, frame);
+		if (ret < 0) {
+			dev_warn_ratelimited(kbd->dev, "Event frame read failed: %d\n", ret);
+			break;
+		}
+		if (ret == 0)
 			break;
 		
-		/* Debug: log every FIFO read */
-		dev_info(&kbd->client->dev, "FIFO[%d]: raw=0x%02x type=%d code=%d\n",
-			 i, fifo_data, event_type, keycode);
+		seq = frame[0];
+		lost = 0;
+		if (kbd->frame_seq_valid) {
+			/* A repeat of a frame we already handled */
+			if (seq == kbd->last_frame_seq)
+				continue;
+			lost = seq - kbd->last_frame_seq - 1;
+			if (lost) {
+				kbd->stats.frames_lost += lost;
+				dev_warn_ratelimited(kbd->dev, "Lost %u event frame(s)\n",
+						     lost);
+			}
+		}
+		kbd->last_frame_seq = seq;
+		kbd->frame_seq_valid = true;
+		trace_lyra_kbd_frame(kbd->dev, seq, ret, lost);
 		
-		switch (event_type) {
-		case FIFO_EVENT_PRESS:
-			pressed = true;
-			break;
-		case FIFO_EVENT_RELEASE:
-			pressed = false;
-			break;
-		case FIFO_EVENT_HOLD:
+		for (i = 0; i < ret; i++) {
 			/*
-			 * Ignore HOLD events - let kernel handle auto-repeat.
-			 * Processing HOLD as PRESS can cause stuck keys if
-			 * release events are missed, especially for direct
-			 * GPIO keys (FN1-FN8).
+			 * Events of the same age share one input_sync() and
+			 * are stamped with the time the firmware saw them,
+			 * so typematic repeats keep their cadence however
+			 * late the poll runs.
 			 */
-			dev_info(&kbd->client->dev, "  -> Ignoring HOLD event for keycode %d\n", keycode);
-			goto next;
-		default:
-			dev_warn(&kbd->client->dev, "  -> Unknown event type: %d (raw=0x%02x)\n",
-				 event_type, fifo_data);
-			goto next;
+			if (kbd->use_timestamps &&
+			    (i == 0 || frame[FRAME_AGES + i] != frame[FRAME_AGES + i - 1])) {
+				if (i > 0)
+					input_sync(kbd->kbd_input);
+				input_set_timestamp(kbd->kbd_input,
+						    ktime_sub_ms(built, frame[FRAME_AGES + i]));
+			}
+			trace_lyra_kbd_fifo_read(kbd->dev, REG_EVENT_FRAME, i, frame[2 + i]);
+			lyra_kbd_dispatch_event(kbd, frame[2 + i]);
 		}
+		input_sync(kbd->kbd_input);
+		events += ret;
 		
-		lyra_kbd_process_key_event(kbd, keycode, pressed);
-
-		/* safety label to keep single exit for each loop iteration */
-next:
-		i++;
+		/* A short frame means the firmware queue is drained */
+		if (ret < FRAME_MAX_EVENTS)
+			break;
 	}
-	if (i > 0)
-		dev_info(&kbd->client->dev, "FIFO processing done. Processed %d events.\n", i);
+	
+	return events;
 }
 
-static void lyra_kbd_process_mouse(struct lyra_kbd_data *kbd)
+static void lyra_kbd_report_mouse(struct lyra_kbd_data *kbd, s8 delta_x, s8 delta_y)
 {
-	int ret;
-	s8 delta_x, delta_y;
-	s32 adjusted_x, adjusted_y;
-	
-	/* Read mouse X delta */
-	ret = lyra_kbd_read_reg(kbd->client, REG_MOUSE_X);
-	if (ret < 0)
-		return;
-	delta_x = (s8)ret;
-	
-	/* Read mouse Y delta */
-	ret = lyra_kbd_read_reg(kbd->client, REG_MOUSE_Y);
-	if (ret < 0)
-		return;
-	delta_y = (s8)ret;
+	s32 adjusted_x = 0, adjusted_y = 0;
 	
 	/* Apply speed multiplier */
 	if (delta_x != 0) {
@@ -441,8 +956,30 @@ static void lyra_kbd_process_mouse(struct lyra_kbd_data *kbd)
 		input_report_rel(kbd->mouse_input, REL_Y, adjusted_y);
 	}
 	
-	if (delta_x != 0 || delta_y != 0)
+	if (delta_x != 0 || delta_y != 0) {
+		trace_lyra_kbd_mouse(kbd->dev, delta_x, delta_y, adjusted_x, adjusted_y);
 		input_sync(kbd->mouse_input);
+	}
+}
+
+static void lyra_kbd_process_mouse(struct lyra_kbd_data *kbd)
+{
+	int ret;
+	s8 delta_x, delta_y;
+	
+	/* Read mouse X delta */
+	ret = lyra_kbd_read_reg(kbd, REG_MOUSE_X);
+	if (ret < 0)
+		return;
+	delta_x = (s8)ret;
+	
+	/* Read mouse Y delta */
+	ret = lyra_kbd_read_reg(kbd, REG_MOUSE_Y);
+	if (ret < 0)
+		return;
+	delta_y = (s8)ret;
+	
+	lyra_kbd_report_mouse(kbd, delta_x, delta_y);
 }
 
 static void lyra_kbd_process_power_button(struct lyra_kbd_data *kbd, bool pressed)
@@ -451,22 +988,45 @@ static void lyra_kbd_process_power_button(struct lyra_kbd_data *kbd, bool presse
 		kbd->power_btn_pressed = pressed;
 		input_report_key(kbd->kbd_input, KEY_POWER, pressed);
 		input_sync(kbd->kbd_input);
-		dev_info(&kbd->client->dev, "Power button %s\n", 
-			 pressed ? "pressed" : "released");
+		dev_dbg(kbd->dev, "Power button %s\n",
+			pressed ? "pressed" : "released");
 	}
 }
 
-static void lyra_kbd_sync_modifiers(struct lyra_kbd_data *kbd)
+/*
+ * Report KEY_POWER from the power status register. A press that started
+ * and ended between two reads still yields a press and a release.
+ */
+static void lyra_kbd_process_power_status(struct lyra_kbd_data *kbd, u8 status)
 {
-	int ret;
-	u8 key_status;
-	bool shift, alt;
+	bool pressed = status & POWER_STATUS_BUTTON;
+	
+	if ((status & POWER_STATUS_PRESSED) && !pressed)
+		lyra_kbd_process_power_button(kbd, true);
+	lyra_kbd_process_power_button(kbd, pressed);
+	
+	if (status & POWER_STATUS_LONG_PRESS)
+		dev_dbg(kbd->dev, "Power button long press\n");
+	
+	/*
+	 * The firmware holds the power latch for its grace time, or until
+	 * the power-off handler below tells it the system is down
+	 */
+	if ((status & POWER_STATUS_SHUTDOWN) && !kbd->shutdown_requested) {
+		kbd->shutdown_requested = true;
+		dev_warn(kbd->dev, "Shutdown requested by power button\n");
+		if (!kbd->power_btn_pressed) {
+			lyra_kbd_process_power_button(kbd, true);
+			lyra_kbd_process_power_button(kbd, false);
+		}
+		orderly_poweroff(true);
+	}
+}
 
-	ret = lyra_kbd_read_reg(kbd->client, REG_KEY_STATUS);
-	if (ret < 0)
-		return;
+static void lyra_kbd_report_modifiers(struct lyra_kbd_data *kbd, u8 key_status)
+{
+	bool shift, alt;
 
-	key_status = (u8)ret;
 	shift = (key_status & KEY_STATUS_SHIFT_BIT) != 0;
 	alt = (key_status & KEY_STATUS_ALT_BIT) != 0;
 
@@ -478,51 +1038,233 @@ static void lyra_kbd_sync_modifiers(struct lyra_kbd_data *kbd)
 	input_report_key(kbd->kbd_input, KEY_LEFTALT, alt);
 	input_sync(kbd->kbd_input);
 	
-	dev_dbg(&kbd->client->dev, "Synced modifiers: shift=%d alt=%d\n", shift, alt);
+	if (key_status & KEY_STATUS_ROLLOVER_BIT)
+		dev_dbg(kbd->dev, "Matrix rollover limit hit, ghost keys suppressed\n");
+	
+	dev_dbg(kbd->dev, "Synced modifiers: shift=%d alt=%d\n", shift, alt);
 }
 
-static void lyra_kbd_poll_work(struct work_struct *work)
+static void lyra_kbd_sync_modifiers(struct lyra_kbd_data *kbd)
 {
-	struct lyra_kbd_data *kbd = container_of(work, struct lyra_kbd_data,
-						  poll_work.work);
 	int ret;
-	u8 int_status;
+
+	ret = lyra_kbd_get_key_status(kbd);
+	if (ret >= 0)
+		lyra_kbd_report_modifiers(kbd, (u8)ret);
+}
+
+/*
+ * Next poll delay: fast while anything happened within the hold time,
+ * otherwise back off exponentially towards the idle interval.
+ */
+static unsigned int lyra_kbd_next_poll_delay(struct lyra_kbd_data *kbd, u8 int_status)
+{
+	unsigned int fast = min(kbd->poll_active_ms, kbd->poll_interval_ms);
 	
-	/* Read interrupt status */
-	ret = lyra_kbd_read_reg(kbd->client, REG_INT_STATUS);
-	if (ret < 0)
-		goto reschedule;
+	if (int_status) {
+		kbd->last_activity = jiffies;
+		pm_runtime_mark_last_busy(kbd->dev);
+	}
 	
-	int_status = (u8)ret;
+	if (time_before(jiffies, kbd->last_activity + msecs_to_jiffies(kbd->poll_hold_ms)))
+		kbd->poll_current_ms = fast;
+	else
+		kbd->poll_current_ms = clamp(kbd->poll_current_ms * 2, fast,
+					     kbd->poll_interval_ms);
+	
+	return kbd->poll_current_ms;
+}
+
+static enum hrtimer_restart lyra_kbd_poll_timer(struct hrtimer *timer)
+{
+	struct lyra_kbd_data *kbd = container_of(timer, struct lyra_kbd_data,
+						  poll_timer);
+	
+	kthread_queue_work(kbd->poll_worker, &kbd->poll_work);
+	
+	return HRTIMER_NORESTART;
+}
+
+/* Restart the curve at the active rate, as after a key press */
+static void lyra_kbd_poll_start(struct lyra_kbd_data *kbd)
+{
+	kbd->last_activity = jiffies;
+	kbd->poll_current_ms = min(kbd->poll_active_ms, kbd->poll_interval_ms);
+	WRITE_ONCE(kbd->polling, true);
+	hrtimer_start(&kbd->poll_timer, ms_to_ktime(kbd->poll_current_ms),
+		      HRTIMER_MODE_REL);
+}
+
+/* Stop polling; the work sees the flag and does not re-arm the timer */
+static void lyra_kbd_poll_stop(struct lyra_kbd_data *kbd)
+{
+	WRITE_ONCE(kbd->polling, false);
+	hrtimer_cancel(&kbd->poll_timer);
+	kthread_cancel_work_sync(&kbd->poll_work);
+	hrtimer_cancel(&kbd->poll_timer);
+}
+
+/* Act on an interrupt status read at start */
+static void lyra_kbd_handle_int_status(struct lyra_kbd_data *kbd, u8 int_status,
+				       ktime_t start)
+{
+	int ret, events;
 	
 	/* Sync modifiers if hardware reports a change */
 	if (int_status & (INT_STATUS_SHIFT_CHANGE | INT_STATUS_ALT_CHANGE | INT_STATUS_FN_CHANGE))
 		lyra_kbd_sync_modifiers(kbd);
 
 	/* Check for FIFO overflow */
-	if (int_status & INT_STATUS_FIFO_OVERFLOW)
-		dev_warn(&kbd->client->dev, "FIFO overflow detected\n");
+	if (int_status & INT_STATUS_FIFO_OVERFLOW) {
+		kbd->stats.fifo_overflows++;
+		dev_warn_ratelimited(kbd->dev, "FIFO overflow detected\n");
+	}
 	
 	/* Process keyboard events */
-	if (int_status & INT_STATUS_KEY_EVENT)
-		lyra_kbd_process_fifo(kbd);
+	if (int_status & (INT_STATUS_KEY_EVENT | INT_STATUS_FIFO_WATERMARK)) {
+		if (kbd->use_frames)
+			events = lyra_kbd_process_frames(kbd);
+		else
+			events = lyra_kbd_process_fifo(kbd);
+		lyra_kbd_count_drain(kbd, events, start);
+	}
 	
 	/* Process mouse events */
 	if (int_status & INT_STATUS_MOUSE_EVENT)
 		lyra_kbd_process_mouse(kbd);
 	
-	/* Process power button */
+	/* Process power button; legacy firmware only signals a change */
 	if (int_status & INT_STATUS_POWER_BTN) {
-		/* Read key status to get current power button state */
-		/* Assuming power button state is tracked separately by firmware */
-		/* For now, toggle on each power button interrupt */
-		lyra_kbd_process_power_button(kbd, !kbd->power_btn_pressed);
+		if (kbd->caps & CAP_POWER_STATUS) {
+			ret = lyra_kbd_read_reg(kbd, REG_POWER_STATUS);
+			if (ret >= 0)
+				lyra_kbd_process_power_status(kbd, (u8)ret);
+		} else {
+			lyra_kbd_process_power_button(kbd, !kbd->power_btn_pressed);
+		}
+	}
+}
+
+static void lyra_kbd_poll_work(struct kthread_work *work)
+{
+	struct lyra_kbd_data *kbd = container_of(work, struct lyra_kbd_data,
+						  poll_work);
+	ktime_t start = ktime_get();
+	unsigned int delay;
+	int ret;
+	u8 int_status = 0;
+	
+	/* Read interrupt status */
+	ret = lyra_kbd_read_reg(kbd, REG_INT_STATUS);
+	if (ret >= 0) {
+		int_status = (u8)ret;
+		lyra_kbd_handle_int_status(kbd, int_status, start);
+	}
+	
+	delay = lyra_kbd_next_poll_delay(kbd, int_status);
+	
+	if (!READ_ONCE(kbd->polling))
+		return;
+	
+	/* Idle: let runtime PM suspend once the autosuspend delay has passed */
+	if (!int_status && kbd->autosuspend)
+		pm_request_autosuspend(kbd->dev);
+	
+	/* FIFO is filling up: keep draining without waiting a poll period */
+	if (int_status & INT_STATUS_FIFO_WATERMARK)
+		kthread_queue_work(kbd->poll_worker, &kbd->poll_work);
+	else
+		hrtimer_start(&kbd->poll_timer, ms_to_ktime(delay), HRTIMER_MODE_REL);
+}
+
+static void lyra_kbd_destroy_poll_worker(void *data)
+{
+	kthread_destroy_worker(data);
+}
+
+/*
+ * Create the per-device poll worker. It runs at the lowest SCHED_FIFO
+ * priority: above every normal task, below threaded IRQ handlers.
+ */
+static int lyra_kbd_poll_init(struct lyra_kbd_data *kbd)
+{
+	int error;
+	
+	kbd->poll_worker = kthread_create_worker(0, "lyra_kbd/%s", dev_name(kbd->dev));
+	if (IS_ERR(kbd->poll_worker))
+		return PTR_ERR(kbd->poll_worker);
+	
+	error = devm_add_action_or_reset(kbd->dev, lyra_kbd_destroy_poll_worker,
+					 kbd->poll_worker);
+	if (error)
+		return error;
+	
+	sched_set_fifo_low(kbd->poll_worker->task);
+	
+	kthread_init_work(&kbd->poll_work, lyra_kbd_poll_work);
+	hrtimer_init(&kbd->poll_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	kbd->poll_timer.function = lyra_kbd_poll_timer;
+	
+	return 0;
+}
+
+/*
+ * The firmware asserts its interrupt line whenever it has something to
+ * report. Polling carries on regardless, so the interrupt only shortens
+ * the wait for the next poll, or wakes an autosuspended device. The
+ * runtime PM reference is held until the poll is queued so an autosuspend
+ * in progress cannot leave the line asserted with nobody to drain it.
+ */
+static irqreturn_t lyra_kbd_irq(int irq, void *dev_id)
+{
+	struct lyra_kbd_data *kbd = dev_id;
+	int error;
+	
+	/* Resuming drains the device itself */
+	error = pm_runtime_resume_and_get(kbd->dev);
+	
+	if (READ_ONCE(kbd->polling))
+		kthread_queue_work(kbd->poll_worker, &kbd->poll_work);
+	
+	if (!error) {
+		pm_runtime_mark_last_busy(kbd->dev);
+		pm_runtime_put_autosuspend(kbd->dev);
 	}
 	
-reschedule:
-	/* Reschedule work */
-	schedule_delayed_work(&kbd->poll_work,
-			      msecs_to_jiffies(kbd->poll_interval_ms));
+	return IRQ_HANDLED;
+}
+
+/* Optional: the board may leave the interrupt line unconnected */
+static int lyra_kbd_setup_irq(struct lyra_kbd_data *kbd)
+{
+	struct i2c_client *client = kbd->client;
+	int error;
+	
+	if (client->irq <= 0)
+		return 0;
+	
+	error = devm_request_threaded_irq(kbd->dev, client->irq, NULL, lyra_kbd_irq,
+					  IRQF_ONESHOT, dev_name(kbd->dev), kbd);
+	if (error) {
+		dev_err(kbd->dev, "Failed to request IRQ %d: %d\n", client->irq, error);
+		return error;
+	}
+	
+	/*
+	 * A keystroke wakes the system by default. The i2c core has already
+	 * done this for a node with "wakeup-source", and clears the wake IRQ
+	 * on remove either way.
+	 */
+	if (!(client->flags & I2C_CLIENT_WAKE)) {
+		error = dev_pm_set_wake_irq(kbd->dev, client->irq);
+		if (error) {
+			dev_err(kbd->dev, "Failed to set wake IRQ: %d\n", error);
+			return error;
+		}
+		device_init_wakeup(kbd->dev, true);
+	}
+	
+	return 0;
 }
 
 /* Sysfs attributes for mouse speed */
@@ -596,7 +1338,7 @@ static ssize_t poll_interval_store(struct device *dev,
 	if (kstrtouint(buf, 10, &val))
 		return -EINVAL;
 	
-	if (val < 5 || val > 100)
+	if (val < 5 || val > 1000)
 		return -EINVAL;
 	
 	kbd->poll_interval_ms = val;
@@ -604,14 +1346,80 @@ static ssize_t poll_interval_store(struct device *dev,
 	return count;
 }
 
+static ssize_t poll_active_interval_show(struct device *dev,
+					  struct device_attribute *attr, char *buf)
+{
+	struct lyra_kbd_data *kbd = dev_get_drvdata(dev);
+	
+	return sprintf(buf, "%u\n", kbd->poll_active_ms);
+}
+
+static ssize_t poll_active_interval_store(struct device *dev,
+					   struct device_attribute *attr,
+					   const char *buf, size_t count)
+{
+	struct lyra_kbd_data *kbd = dev_get_drvdata(dev);
+	unsigned int val;
+	
+	if (kstrtouint(buf, 10, &val))
+		return -EINVAL;
+	
+	if (val < 1 || val > 100)
+		return -EINVAL;
+	
+	kbd->poll_active_ms = val;
+	
+	return count;
+}
+
+static ssize_t poll_hold_time_show(struct device *dev,
+				    struct device_attribute *attr, char *buf)
+{
+	struct lyra_kbd_data *kbd = dev_get_drvdata(dev);
+	
+	return sprintf(buf, "%u\n", kbd->poll_hold_ms);
+}
+
+static ssize_t poll_hold_time_store(struct device *dev,
+				     struct device_attribute *attr,
+				     const char *buf, size_t count)
+{
+	struct lyra_kbd_data *kbd = dev_get_drvdata(dev);
+	unsigned int val;
+	
+	if (kstrtouint(buf, 10, &val))
+		return -EINVAL;
+	
+	if (val > 10000)
+		return -EINVAL;
+	
+	kbd->poll_hold_ms = val;
+	
+	return count;
+}
+
+static ssize_t poll_current_show(struct device *dev,
+				  struct device_attribute *attr, char *buf)
+{
+	struct lyra_kbd_data *kbd = dev_get_drvdata(dev);
+	
+	return sprintf(buf, "%u\n", kbd->poll_current_ms);
+}
+
 static DEVICE_ATTR_RW(mouse_speed_x);
 static DEVICE_ATTR_RW(mouse_speed_y);
 static DEVICE_ATTR_RW(poll_interval);
+static DEVICE_ATTR_RW(poll_active_interval);
+static DEVICE_ATTR_RW(poll_hold_time);
+static DEVICE_ATTR_RO(poll_current);
 
 static struct attribute *lyra_kbd_attrs[] = {
 	&dev_attr_mouse_speed_x.attr,
 	&dev_attr_mouse_speed_y.attr,
 	&dev_attr_poll_interval.attr,
+	&dev_attr_poll_active_interval.attr,
+	&dev_attr_poll_hold_time.attr,
+	&dev_attr_poll_current.attr,
 	NULL,
 };
 
@@ -619,20 +1427,118 @@ static const struct attribute_group lyra_kbd_attr_group = {
 	.attrs = lyra_kbd_attrs,
 };
 
+/* Print a counter with its average rate per second since elapsed_us */
+static void lyra_kbd_show_rate(struct seq_file *s, const char *name, u64 count,
+			       s64 elapsed_us)
+{
+	u64 rate = 0;
+	u32 frac;
+	
+	/* Hundredths per second */
+	if (elapsed_us > 0)
+		rate = div64_u64(count * 100 * USEC_PER_SEC, elapsed_us);
+	rate = div_u64_rem(rate, 100, &frac);
+	
+	seq_printf(s, "%-15s %llu (%llu.%02u/s)\n", name, count, rate, frac);
+}
+
+static int lyra_kbd_stats_show(struct seq_file *s, void *unused)
+{
+	struct lyra_kbd_data *kbd = s->private;
+	struct lyra_kbd_stats *stats = &kbd->stats;
+	s64 elapsed_us = ktime_us_delta(ktime_get(), stats->since);
+	
+	seq_printf(s, "elapsed_ms:     %lld\n", div_s64(elapsed_us, USEC_PER_MSEC));
+	lyra_kbd_show_rate(s, "transfers:", stats->transfers, elapsed_us);
+	lyra_kbd_show_rate(s, "bytes:", stats->bytes, elapsed_us);
+	seq_printf(s, "errors:         %llu\n", stats->errors);
+	seq_printf(s, "crc_errors:     %llu\n", stats->crc_errors);
+	seq_printf(s, "fifo_overflows: %llu\n", stats->fifo_overflows);
+	seq_printf(s, "frames_lost:    %llu\n", stats->frames_lost);
+	seq_printf(s, "events:         %llu\n", stats->events);
+	seq_printf(s, "drains:         %llu\n", stats->drains);
+	seq_printf(s, "poll_current:   %u ms\n", kbd->poll_current_ms);
+	
+	return 0;
+}
+
+static int lyra_kbd_stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, lyra_kbd_stats_show, inode->i_private);
+}
+
+/* Any write resets all statistics */
+static ssize_t lyra_kbd_stats_write(struct file *file, const char __user *buf,
+				    size_t count, loff_t *ppos)
+{
+	struct lyra_kbd_data *kbd = ((struct seq_file *)file->private_data)->private;
+	
+	memset(&kbd->stats, 0, sizeof(kbd->stats));
+	kbd->stats.since = ktime_get();
+	
+	return count;
+}
+
+static const struct file_operations lyra_kbd_stats_fops = {
+	.owner		= THIS_MODULE,
+	.open		= lyra_kbd_stats_open,
+	.read		= seq_read,
+	.write		= lyra_kbd_stats_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int lyra_kbd_histogram_show(struct seq_file *s, void *unused)
+{
+	struct lyra_kbd_data *kbd = s->private;
+	struct lyra_kbd_stats *stats = &kbd->stats;
+	int i;
+	
+	seq_puts(s, "events per drain:\n");
+	for (i = 0; i <= FIFO_MAX_READ; i++)
+		seq_printf(s, "  %2d: %llu\n", i, stats->drain_events[i]);
+	
+	seq_puts(s, "drain latency (us, poll or packet start to input_sync):\n");
+	for (i = 0; i < LATENCY_BUCKETS; i++) {
+		if (i == 0)
+			seq_printf(s, "  %6u        : %llu\n", 0, stats->latency[i]);
+		else if (i < LATENCY_BUCKETS - 1)
+			seq_printf(s, "  %6u-%-6u : %llu\n", 1U << (i - 1),
+				   (1U << i) - 1, stats->latency[i]);
+		else
+			seq_printf(s, "  %6u+       : %llu\n", 1U << (i - 1),
+				   stats->latency[i]);
+	}
+	seq_printf(s, "  max: %u\n", stats->latency_max_us);
+	
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(lyra_kbd_histogram);
+
+static void lyra_kbd_debugfs_init(struct lyra_kbd_data *kbd)
+{
+	kbd->stats.since = ktime_get();
+	kbd->debugfs = debugfs_create_dir(dev_name(kbd->dev), lyra_kbd_debugfs_root);
+	debugfs_create_file("stats", 0600, kbd->debugfs, kbd, &lyra_kbd_stats_fops);
+	debugfs_create_file("histogram", 0400, kbd->debugfs, kbd,
+			    &lyra_kbd_histogram_fops);
+}
+
 static int lyra_kbd_setup_input_devices(struct lyra_kbd_data *kbd)
 {
-	struct i2c_client *client = kbd->client;
+	struct device *dev = kbd->dev;
+	u16 bustype = kbd->serdev ? BUS_RS232 : BUS_I2C;
 	struct input_dev *kbd_input, *mouse_input;
 	int i, error;
 	
 	/* Allocate keyboard input device */
-	kbd_input = devm_input_allocate_device(&client->dev);
+	kbd_input = devm_input_allocate_device(dev);
 	if (!kbd_input)
 		return -ENOMEM;
 	
 	kbd_input->name = "Luckfox Lyra Keyboard";
-	kbd_input->phys = "i2c-keyboard/input0";
-	kbd_input->id.bustype = BUS_I2C;
+	kbd_input->phys = kbd->serdev ? "serial-keyboard/input0" : "i2c-keyboard/input0";
+	kbd_input->id.bustype = bustype;
 	kbd_input->id.vendor = 0x1234;
 	kbd_input->id.product = 0x5678;
 	kbd_input->id.version = 0x0100;
@@ -643,32 +1549,61 @@ static int lyra_kbd_setup_input_devices(struct lyra_kbd_data *kbd)
 	__set_bit(EV_MSC, kbd_input->evbit);
 	__set_bit(MSC_SCAN, kbd_input->mscbit);
 	
-	/* Set all possible keys from keymaps */
+	/* Built-in layout, exposed for EVIOCGKEYCODE/EVIOCSKEYCODE */
 	for (i = 0; i < MAX_KEYCODES; i++) {
-		__set_bit(keymap_normal[i], kbd_input->keybit);
-		__set_bit(keymap_shift[i], kbd_input->keybit);
-		__set_bit(keymap_fn[i], kbd_input->keybit);
+		kbd->keymap[(LYRA_LAYER_NORMAL << KEYMAP_LAYER_SHIFT) | i] = keymap_normal[i];
+		kbd->keymap[(LYRA_LAYER_SHIFT << KEYMAP_LAYER_SHIFT) | i] = keymap_shift[i];
+		kbd->keymap[(LYRA_LAYER_FN << KEYMAP_LAYER_SHIFT) | i] = keymap_fn[i];
+	}
+	for (i = 0; i < KEYMAP_SIZE; i++)
+		__set_bit(kbd->keymap[i], kbd_input->keybit);
+	__clear_bit(KEY_RESERVED, kbd_input->keybit);
+	
+	kbd_input->keycode = kbd->keymap;
+	kbd_input->keycodesize = sizeof(kbd->keymap[0]);
+	kbd_input->keycodemax = KEYMAP_SIZE;
+	
+	/*
+	 * Entries from a linux,keymap property override the built-in layout:
+	 * MATRIX_KEY(layer, code, key) with layer 0 normal, 1 shift, 2 FN
+	 */
+	if (device_property_present(dev, "linux,keymap")) {
+		error = matrix_keypad_build_keymap(NULL, NULL, KEYMAP_LAYERS, KEYMAP_CODES,
+						   kbd->keymap, kbd_input);
+		if (error) {
+			dev_err(dev, "Failed to parse linux,keymap: %d\n", error);
+			return error;
+		}
 	}
 	
-	/* Add power button */
+	/* Modifiers reported from the key status register, and the power button */
+	__set_bit(KEY_LEFTSHIFT, kbd_input->keybit);
+	__set_bit(KEY_LEFTALT, kbd_input->keybit);
 	__set_bit(KEY_POWER, kbd_input->keybit);
 	
+	/*
+	 * Autorepeat is generated by the firmware. Presetting the repeat
+	 * parameters keeps the input core from starting its soft-repeat timer.
+	 */
+	kbd_input->rep[REP_DELAY] = LYRA_REP_DELAY_MS;
+	kbd_input->rep[REP_PERIOD] = LYRA_REP_PERIOD_MS;
+	
 	error = input_register_device(kbd_input);
 	if (error) {
-		dev_err(&client->dev, "Failed to register keyboard: %d\n", error);
+		dev_err(dev, "Failed to register keyboard: %d\n", error);
 		return error;
 	}
 	
 	kbd->kbd_input = kbd_input;
 	
 	/* Allocate mouse input device */
-	mouse_input = devm_input_allocate_device(&client->dev);
+	mouse_input = devm_input_allocate_device(dev);
 	if (!mouse_input)
 		return -ENOMEM;
 	
 	mouse_input->name = "Luckfox Lyra Mouse";
-	mouse_input->phys = "i2c-keyboard/input1";
-	mouse_input->id.bustype = BUS_I2C;
+	mouse_input->phys = kbd->serdev ? "serial-keyboard/input1" : "i2c-keyboard/input1";
+	mouse_input->id.bustype = bustype;
 	mouse_input->id.vendor = 0x1234;
 	mouse_input->id.product = 0x5679;
 	mouse_input->id.version = 0x0100;
@@ -686,7 +1621,7 @@ static int lyra_kbd_setup_input_devices(struct lyra_kbd_data *kbd)
 	
 	error = input_register_device(mouse_input);
 	if (error) {
-		dev_err(&client->dev, "Failed to register mouse: %d\n", error);
+		dev_err(dev, "Failed to register mouse: %d\n", error);
 		return error;
 	}
 	
@@ -695,6 +1630,133 @@ static int lyra_kbd_setup_input_devices(struct lyra_kbd_data *kbd)
 	return 0;
 }
 
+/*
+ * Runs after every device has been shut down, so storage caches are
+ * flushed: only now may the firmware release the power latch
+ */
+static int lyra_kbd_power_off_prepare(struct sys_off_data *data)
+{
+	struct lyra_kbd_data *kbd = data->cb_data;
+	
+	if (!(kbd->caps & CAP_SHUTDOWN))
+		return NOTIFY_DONE;
+	
+#if IS_ENABLED(CONFIG_SERIAL_DEV_BUS)
+	if (kbd->serdev) {
+		lyra_kbd_serdev_write_reg(kbd, REG_POWER_CTRL, POWER_CMD_OFF);
+		serdev_device_wait_until_sent(kbd->serdev,
+					      msecs_to_jiffies(POWER_OFF_TIMEOUT_MS));
+		return NOTIFY_DONE;
+	}
+#endif
+	lyra_kbd_write_reg(kbd, REG_POWER_CTRL, POWER_CMD_OFF);
+	
+	return NOTIFY_DONE;
+}
+
+static int lyra_kbd_register_power_off(struct lyra_kbd_data *kbd)
+{
+	return PTR_ERR_OR_ZERO(devm_register_sys_off_handler(kbd->dev,
+							     SYS_OFF_MODE_POWER_OFF_PREPARE,
+							     SYS_OFF_PRIO_DEFAULT,
+							     lyra_kbd_power_off_prepare,
+							     kbd));
+}
+
+static const enum power_supply_property lyra_kbd_battery_props[] = {
+	POWER_SUPPLY_PROP_STATUS,
+	POWER_SUPPLY_PROP_PRESENT,
+	POWER_SUPPLY_PROP_TECHNOLOGY,
+	POWER_SUPPLY_PROP_VOLTAGE_NOW,
+	POWER_SUPPLY_PROP_CAPACITY,
+	POWER_SUPPLY_PROP_CAPACITY_LEVEL,
+	POWER_SUPPLY_PROP_SCOPE,
+};
+
+static int lyra_kbd_battery_get_property(struct power_supply *psy,
+					 enum power_supply_property psp,
+					 union power_supply_propval *val)
+{
+	struct lyra_kbd_data *kbd = power_supply_get_drvdata(psy);
+	u8 block[BATTERY_BLOCK_LEN];
+	int ret;
+	
+	switch (psp) {
+	case POWER_SUPPLY_PROP_TECHNOLOGY:
+		val->intval = POWER_SUPPLY_TECHNOLOGY_LION;
+		return 0;
+	case POWER_SUPPLY_PROP_SCOPE:
+		val->intval = POWER_SUPPLY_SCOPE_SYSTEM;
+		return 0;
+	case POWER_SUPPLY_PROP_STATUS:
+		/* No charger sense line, only the cell voltage is known */
+		val->intval = POWER_SUPPLY_STATUS_UNKNOWN;
+		return 0;
+	default:
+		break;
+	}
+	
+	/* The firmware filters the ADC, a block read is a complete reading */
+	ret = i2c_smbus_read_i2c_block_data(kbd->client, REG_BATTERY_BASE,
+					    sizeof(block), block);
+	lyra_kbd_count_transfer(kbd, ret, 1 + sizeof(block));
+	if (ret < 0) {
+		trace_lyra_kbd_i2c_error(kbd->dev, REG_BATTERY_BASE, ret);
+		return ret;
+	}
+	if (ret != sizeof(block))
+		return -EIO;
+	if (!(block[BATTERY_FLAGS] & BATTERY_FLAG_VALID))
+		return -ENODATA;
+	
+	switch (psp) {
+	case POWER_SUPPLY_PROP_PRESENT:
+		val->intval = !!(block[BATTERY_FLAGS] & BATTERY_FLAG_PRESENT);
+		break;
+	case POWER_SUPPLY_PROP_VOLTAGE_NOW:
+		val->intval = get_unaligned_le16(&block[BATTERY_VOLTAGE]) * 1000;
+		break;
+	case POWER_SUPPLY_PROP_CAPACITY:
+		val->intval = block[BATTERY_PERCENT];
+		break;
+	case POWER_SUPPLY_PROP_CAPACITY_LEVEL:
+		if (block[BATTERY_FLAGS] & BATTERY_FLAG_LOW)
+			val->intval = POWER_SUPPLY_CAPACITY_LEVEL_LOW;
+		else
+			val->intval = POWER_SUPPLY_CAPACITY_LEVEL_NORMAL;
+		break;
+	default:
+		return -EINVAL;
+	}
+	
+	return 0;
+}
+
+/* Readings are fetched on demand, so only the I2C transport offers them */
+static int lyra_kbd_register_battery(struct lyra_kbd_data *kbd)
+{
+	struct power_supply_config cfg = { .drv_data = kbd };
+	
+	if (!IS_ENABLED(CONFIG_POWER_SUPPLY) || !(kbd->caps & CAP_BATTERY) ||
+	    !i2c_check_functionality(kbd->client->adapter, I2C_FUNC_SMBUS_READ_I2C_BLOCK))
+		return 0;
+	
+	kbd->battery_desc.name = "lyra-kbd-battery";
+	kbd->battery_desc.type = POWER_SUPPLY_TYPE_BATTERY;
+	kbd->battery_desc.properties = lyra_kbd_battery_props;
+	kbd->battery_desc.num_properties = ARRAY_SIZE(lyra_kbd_battery_props);
+	kbd->battery_desc.get_property = lyra_kbd_battery_get_property;
+	
+	kbd->battery = devm_power_supply_register(kbd->dev, &kbd->battery_desc, &cfg);
+	if (IS_ERR(kbd->battery)) {
+		dev_err(kbd->dev, "Failed to register battery: %ld\n",
+			PTR_ERR(kbd->battery));
+		return PTR_ERR(kbd->battery);
+	}
+	
+	return 0;
+}
+
 static int lyra_kbd_probe(struct i2c_client *client,
 			   const struct i2c_device_id *id)
 {
@@ -712,33 +1774,91 @@ static int lyra_kbd_probe(struct i2c_client *client,
 	if (!kbd)
 		return -ENOMEM;
 	
+	kbd->dev = &client->dev;
 	kbd->client = client;
 	kbd->mouse_speed_x = 100; /* 1x speed */
 	kbd->mouse_speed_y = 100;
+	kbd->poll_active_ms = POLL_ACTIVE_MS;
+	kbd->poll_hold_ms = POLL_HOLD_MS;
 	kbd->poll_interval_ms = POLL_INTERVAL_MS;
 	
 	i2c_set_clientdata(client, kbd);
 	
+	/* Discover firmware protocol version and capabilities */
+	lyra_kbd_probe_caps(kbd);
+	
+	/* Prefer CRC-protected event frames when both ends support them */
+	if ((kbd->caps & CAP_EVENT_FRAMES) &&
+	    i2c_check_functionality(client->adapter, I2C_FUNC_SMBUS_READ_I2C_BLOCK)) {
+		kbd->use_frames = true;
+		kbd->use_timestamps = !!(kbd->caps & CAP_TIMESTAMPS);
+		dev_info(&client->dev, "Using framed event mode%s\n",
+			 kbd->use_timestamps ? " with event timestamps" : "");
+	} else if ((kbd->caps & CAP_BURST_READ) &&
+		   i2c_check_functionality(client->adapter, I2C_FUNC_I2C)) {
+		kbd->use_fifo_batch = true;
+	}
+	
+	/* Waking the firmware takes a combined transfer */
+	kbd->low_power = (kbd->caps & CAP_LOW_POWER) &&
+			 i2c_check_functionality(client->adapter, I2C_FUNC_I2C);
+	
 	/* Setup input devices */
 	error = lyra_kbd_setup_input_devices(kbd);
 	if (error)
 		return error;
 	
+	error = lyra_kbd_poll_init(kbd);
+	if (error) {
+		dev_err(&client->dev, "Failed to create poll worker: %d\n", error);
+		return error;
+	}
+	
+	error = lyra_kbd_register_power_off(kbd);
+	if (error)
+		return error;
+	
+	error = lyra_kbd_register_battery(kbd);
+	if (error)
+		return error;
+	
+	error = lyra_kbd_setup_irq(kbd);
+	if (error)
+		return error;
+	
 	/* Create sysfs attributes */
-	error = sysfs_create_group(&client->dev.kobj, &lyra_kbd_attr_group);
+	error = sysfs_create_group(&kbd->dev->kobj, &lyra_kbd_attr_group);
 	if (error) {
 		dev_err(&client->dev, "Failed to create sysfs group: %d\n", error);
 		return error;
 	}
 	
-	/* Initialize and start polling work */
-	INIT_DELAYED_WORK(&kbd->poll_work, lyra_kbd_poll_work);
+	lyra_kbd_debugfs_init(kbd);
 	
 	/* Initial modifier sync */
 	lyra_kbd_sync_modifiers(kbd);
+	
+	/*
+	 * Discard power button events latched before the driver bound, such
+	 * as the power-on press, so they are not taken for a shutdown request
+	 */
+	if (kbd->caps & CAP_POWER_STATUS)
+		lyra_kbd_read_reg(kbd, REG_POWER_STATUS);
 
-	schedule_delayed_work(&kbd->poll_work,
-			      msecs_to_jiffies(kbd->poll_interval_ms));
+	lyra_kbd_poll_start(kbd);
+	
+	/*
+	 * Autosuspend puts the firmware to sleep when idle, which needs the
+	 * interrupt line to notice the next keystroke
+	 */
+	pm_runtime_set_active(&client->dev);
+	if (kbd->low_power && client->irq > 0) {
+		kbd->autosuspend = true;
+		pm_runtime_set_autosuspend_delay(&client->dev, LYRA_AUTOSUSPEND_MS);
+		pm_runtime_use_autosuspend(&client->dev);
+		pm_runtime_mark_last_busy(&client->dev);
+		pm_runtime_enable(&client->dev);
+	}
 	
 	dev_info(&client->dev, "Luckfox Lyra keyboard/mouse initialized\n");
 	
@@ -749,19 +1869,162 @@ static void lyra_kbd_remove(struct i2c_client *client)
 {
 	struct lyra_kbd_data *kbd = i2c_get_clientdata(client);
 	
-	/* Cancel polling work */
-	cancel_delayed_work_sync(&kbd->poll_work);
+	/* No runtime resume may restart polling once it has stopped */
+	if (kbd->autosuspend) {
+		pm_runtime_disable(&client->dev);
+		pm_runtime_dont_use_autosuspend(&client->dev);
+	}
+	
+	/* Stop polling */
+	lyra_kbd_poll_stop(kbd);
+	
+	debugfs_remove_recursive(kbd->debugfs);
 	
 	/* Remove sysfs attributes */
 	sysfs_remove_group(&client->dev.kobj, &lyra_kbd_attr_group);
 }
 
+/* No bus traffic from the poll worker once the system goes down */
+static void lyra_kbd_shutdown(struct i2c_client *client)
+{
+	struct lyra_kbd_data *kbd = i2c_get_clientdata(client);
+	
+	if (kbd->autosuspend)
+		pm_runtime_disable(&client->dev);
+	lyra_kbd_poll_stop(kbd);
+}
+
+/*
+ * Wake the firmware and bring the driver back in step with it in one
+ * combined transfer: the wake command, then key, power and interrupt
+ * status with repeated starts in between. Whatever happened while it
+ * slept, including the keystroke that woke it, is handled as a poll would.
+ */
+static void lyra_kbd_wake(struct lyra_kbd_data *kbd)
+{
+	struct i2c_client *client = kbd->client;
+	u8 wake[2] = { REG_POWER_CTRL, POWER_CMD_WAKE };
+	u8 regs[3] = { REG_KEY_STATUS, REG_POWER_STATUS, REG_INT_STATUS };
+	u8 status[3];
+	struct i2c_msg msgs[] = {
+		{ .addr = client->addr, .len = sizeof(wake), .buf = wake },
+		{ .addr = client->addr, .len = 1, .buf = &regs[0] },
+		{ .addr = client->addr, .flags = I2C_M_RD, .len = 1, .buf = &status[0] },
+		{ .addr = client->addr, .len = 1, .buf = &regs[1] },
+		{ .addr = client->addr, .flags = I2C_M_RD, .len = 1, .buf = &status[1] },
+		{ .addr = client->addr, .len = 1, .buf = &regs[2] },
+		{ .addr = client->addr, .flags = I2C_M_RD, .len = 1, .buf = &status[2] },
+	};
+	ktime_t start = ktime_get();
+	int ret;
+	
+	ret = i2c_transfer(client->adapter, msgs, ARRAY_SIZE(msgs));
+	if (ret >= 0 && ret != ARRAY_SIZE(msgs))
+		ret = -EIO;
+	lyra_kbd_count_transfer(kbd, ret, sizeof(wake) + sizeof(regs) + sizeof(status));
+	if (ret < 0) {
+		/* A keystroke still wakes the firmware, polling picks it up */
+		trace_lyra_kbd_i2c_error(kbd->dev, REG_POWER_CTRL, ret);
+		dev_err_ratelimited(kbd->dev, "Wake transfer failed: %d\n", ret);
+		return;
+	}
+	
+	kbd->key_status = status[0];
+	lyra_kbd_report_modifiers(kbd, status[0]);
+	lyra_kbd_process_power_status(kbd, status[1]);
+	lyra_kbd_handle_int_status(kbd, status[2] & ~(INT_STATUS_SHIFT_CHANGE |
+						       INT_STATUS_ALT_CHANGE |
+						       INT_STATUS_FN_CHANGE |
+						       INT_STATUS_POWER_BTN), start);
+}
+
+/*
+ * Put the firmware to sleep, with polling already stopped. It only sleeps
+ * once every event has been read and keeps its interrupt line asserted
+ * until then, so anything still pending would never produce the edge that
+ * wakes us: drain it and return -EBUSY instead of sending the command.
+ */
+static int lyra_kbd_sleep(struct lyra_kbd_data *kbd)
+{
+	int ret;
+	
+	ret = lyra_kbd_read_reg(kbd, REG_INT_STATUS);
+	if (ret < 0)
+		return ret;
+	if (ret) {
+		lyra_kbd_handle_int_status(kbd, (u8)ret, ktime_get());
+		return -EBUSY;
+	}
+	
+	ret = lyra_kbd_get_key_status(kbd);
+	if (ret < 0)
+		return ret;
+	if (ret & KEY_STATUS_FIFO_MASK)
+		return -EBUSY;
+	
+	ret = lyra_kbd_write_reg(kbd, REG_POWER_CTRL, POWER_CMD_SLEEP);
+	if (ret < 0)
+		return ret;
+	
+	dev_dbg(kbd->dev, "Firmware asleep\n");
+	return 0;
+}
+
+static int __maybe_unused lyra_kbd_runtime_suspend(struct device *dev)
+{
+	struct lyra_kbd_data *kbd = dev_get_drvdata(dev);
+	
+	lyra_kbd_poll_stop(kbd);
+	
+	if (lyra_kbd_sleep(kbd)) {
+		pm_runtime_mark_last_busy(dev);
+		lyra_kbd_poll_start(kbd);
+		return -EBUSY;
+	}
+	
+	return 0;
+}
+
+static int __maybe_unused lyra_kbd_runtime_resume(struct device *dev)
+{
+	struct lyra_kbd_data *kbd = dev_get_drvdata(dev);
+	
+	lyra_kbd_wake(kbd);
+	pm_runtime_mark_last_busy(dev);
+	lyra_kbd_poll_start(kbd);
+	
+	return 0;
+}
+
 static int __maybe_unused lyra_kbd_suspend(struct device *dev)
 {
 	struct lyra_kbd_data *kbd = dev_get_drvdata(dev);
+	int error;
+	
+	/* Already asleep after an autosuspend */
+	if (pm_runtime_status_suspended(dev))
+		return 0;
 	
 	/* Stop polling during suspend */
-	cancel_delayed_work_sync(&kbd->poll_work);
+	lyra_kbd_poll_stop(kbd);
+	
+	if (!kbd->low_power)
+		return 0;
+	
+	/* The first attempt may just have drained what was queued */
+	error = lyra_kbd_sleep(kbd);
+	if (error == -EBUSY)
+		error = lyra_kbd_sleep(kbd);
+	
+	/*
+	 * Still busy: the interrupt line stays low, so no keystroke could
+	 * wake the system. Abort as a wakeup event would. Otherwise the
+	 * firmware simply stays awake and resume reads what is left.
+	 */
+	if (error == -EBUSY && kbd->client->irq > 0 && device_may_wakeup(dev)) {
+		lyra_kbd_poll_start(kbd);
+		return -EBUSY;
+	}
 	
 	return 0;
 }
@@ -770,14 +2033,30 @@ static int __maybe_unused lyra_kbd_resume(struct device *dev)
 {
 	struct lyra_kbd_data *kbd = dev_get_drvdata(dev);
 	
+	/*
+	 * Resume an autosuspended device too: the keystroke that woke the
+	 * system may have raised its interrupt before runtime PM was back,
+	 * leaving the line asserted with nobody to drain it. It autosuspends
+	 * again once idle.
+	 */
+	if (pm_runtime_status_suspended(dev)) {
+		pm_runtime_resume(dev);
+		return 0;
+	}
+	
+	if (kbd->low_power)
+		lyra_kbd_wake(kbd);
+	
 	/* Resume polling */
-	schedule_delayed_work(&kbd->poll_work,
-			      msecs_to_jiffies(kbd->poll_interval_ms));
+	lyra_kbd_poll_start(kbd);
 	
 	return 0;
 }
 
-static SIMPLE_DEV_PM_OPS(lyra_kbd_pm_ops, lyra_kbd_suspend, lyra_kbd_resume);
+static const struct dev_pm_ops lyra_kbd_pm_ops = {
+	SET_SYSTEM_SLEEP_PM_OPS(lyra_kbd_suspend, lyra_kbd_resume)
+	SET_RUNTIME_PM_OPS(lyra_kbd_runtime_suspend, lyra_kbd_runtime_resume, NULL)
+};
 
 static const struct of_device_id lyra_kbd_of_match[] = {
 	{ .compatible = "luckfox,lyra-keyboard" },
@@ -799,10 +2078,258 @@ static struct i2c_driver lyra_kbd_driver = {
 	},
 	.probe		= lyra_kbd_probe,
 	.remove		= lyra_kbd_remove,
+	.shutdown	= lyra_kbd_shutdown,
 	.id_table	= lyra_kbd_id,
 };
 
-module_i2c_driver(lyra_kbd_driver);
+#if IS_ENABLED(CONFIG_SERIAL_DEV_BUS)
+/*
+ * UART transport: the firmware pushes a report packet whenever it would
+ * have asserted its interrupt line, so there is nothing to poll.
+ */
+static void lyra_kbd_handle_report(struct lyra_kbd_data *kbd, const u8 *payload, u8 len)
+{
+	ktime_t start = ktime_get();
+	u8 int_status;
+	int i;
+	
+	if (len < UART_REPORT_HEADER_LEN)
+		return;
+	
+	kbd->key_status = payload[0];
+	int_status = payload[1];
+	
+	if (int_status & (INT_STATUS_SHIFT_CHANGE | INT_STATUS_ALT_CHANGE | INT_STATUS_FN_CHANGE))
+		lyra_kbd_sync_modifiers(kbd);
+	
+	if (int_status & INT_STATUS_FIFO_OVERFLOW) {
+		kbd->stats.fifo_overflows++;
+		dev_warn_ratelimited(kbd->dev, "FIFO overflow detected\n");
+	}
+	
+	for (i = UART_REPORT_HEADER_LEN; i < len; i++) {
+		trace_lyra_kbd_fifo_read(kbd->dev, REG_FIFO_ACCESS,
+					 i - UART_REPORT_HEADER_LEN, payload[i]);
+		lyra_kbd_dispatch_event(kbd, payload[i]);
+	}
+	if (len > UART_REPORT_HEADER_LEN)
+		input_sync(kbd->kbd_input);
+	lyra_kbd_count_drain(kbd, len - UART_REPORT_HEADER_LEN, start);
+	
+	lyra_kbd_report_mouse(kbd, (s8)payload[2], (s8)payload[3]);
+	
+	/* The power status is fetched with a register read, answered in order */
+	if (int_status & INT_STATUS_POWER_BTN) {
+		if (kbd->caps & CAP_POWER_STATUS)
+			lyra_kbd_serdev_read_reg(kbd, REG_POWER_STATUS);
+		else
+			lyra_kbd_process_power_button(kbd, !kbd->power_btn_pressed);
+	}
+}
+
+static void lyra_kbd_handle_packet(struct lyra_kbd_data *kbd)
+{
+	u8 type = kbd->rx_buf[0];
+	u8 len = kbd->rx_buf[2];
+	const u8 *payload = &kbd->rx_buf[3];
+	
+	switch (type) {
+	case UART_PKT_REPORT:
+		lyra_kbd_handle_report(kbd, payload, len);
+		break;
+	case UART_PKT_ID:
+		if (len >= ID_BLOCK_LEN && payload[ID_MAGIC0] == ID_MAGIC0_VALUE &&
+		    payload[ID_MAGIC1] == ID_MAGIC1_VALUE)
+			lyra_kbd_apply_id(kbd, payload);
+		break;
+	case UART_PKT_REGISTER:
+		if (len >= 2 && payload[0] == REG_POWER_STATUS)
+			lyra_kbd_process_power_status(kbd, payload[1]);
+		break;
+	default:
+		break;
+	}
+}
+
+static int lyra_kbd_serdev_receive_buf(struct serdev_device *serdev,
+				       const unsigned char *data, size_t count)
+{
+	struct lyra_kbd_data *kbd = serdev_device_get_drvdata(serdev);
+	size_t i;
+	
+	kbd->stats.bytes += count;
+	
+	for (i = 0; i < count; i++) {
+		u8 byte = data[i];
+		
+		switch (kbd->rx_state) {
+		case LYRA_RX_WAIT_SYNC:
+			if (byte == UART_SYNC_BYTE) {
+				kbd->rx_pos = 0;
+				kbd->rx_state = LYRA_RX_HEADER;
+			}
+			break;
+		case LYRA_RX_HEADER:
+			kbd->rx_buf[kbd->rx_pos++] = byte;
+			if (kbd->rx_pos < 3)
+				break;
+			if (kbd->rx_buf[2] > UART_MAX_PAYLOAD)
+				kbd->rx_state = LYRA_RX_WAIT_SYNC;
+			else
+				kbd->rx_state = kbd->rx_buf[2] ? LYRA_RX_PAYLOAD : LYRA_RX_CRC;
+			break;
+		case LYRA_RX_PAYLOAD:
+			kbd->rx_buf[kbd->rx_pos++] = byte;
+			if (kbd->rx_pos == 3 + kbd->rx_buf[2])
+				kbd->rx_state = LYRA_RX_CRC;
+			break;
+		case LYRA_RX_CRC:
+			if (crc8(lyra_kbd_crc8_table, kbd->rx_buf, kbd->rx_pos, 0) == byte)
+				lyra_kbd_handle_packet(kbd);
+			else {
+				kbd->stats.crc_errors++;
+				dev_warn_ratelimited(kbd->dev, "Dropped corrupt packet\n");
+			}
+			kbd->rx_state = LYRA_RX_WAIT_SYNC;
+			break;
+		}
+	}
+	
+	return count;
+}
+
+static const struct serdev_device_ops lyra_kbd_serdev_ops = {
+	.receive_buf	= lyra_kbd_serdev_receive_buf,
+	.write_wakeup	= serdev_device_write_wakeup,
+};
+
+static void lyra_kbd_serdev_identify(struct lyra_kbd_data *kbd)
+{
+	u8 packet[5] = { UART_SYNC_BYTE, UART_CMD_IDENTIFY, 0, 0 };
+	
+	packet[4] = crc8(lyra_kbd_crc8_table, &packet[1], 3, 0);
+	serdev_device_write_buf(kbd->serdev, packet, sizeof(packet));
+}
+
+static int lyra_kbd_serdev_probe(struct serdev_device *serdev)
+{
+	struct lyra_kbd_data *kbd;
+	u32 speed = LYRA_UART_BAUDRATE;
+	int error;
+	
+	kbd = devm_kzalloc(&serdev->dev, sizeof(*kbd), GFP_KERNEL);
+	if (!kbd)
+		return -ENOMEM;
+	
+	kbd->dev = &serdev->dev;
+	kbd->serdev = serdev;
+	kbd->mouse_speed_x = 100; /* 1x speed */
+	kbd->mouse_speed_y = 100;
+	kbd->poll_active_ms = POLL_ACTIVE_MS;
+	kbd->poll_hold_ms = POLL_HOLD_MS;
+	kbd->poll_interval_ms = POLL_INTERVAL_MS;
+	kbd->rx_state = LYRA_RX_WAIT_SYNC;
+	
+	serdev_device_set_drvdata(serdev, kbd);
+	
+	/* Input devices must exist before the first packet arrives */
+	error = lyra_kbd_setup_input_devices(kbd);
+	if (error)
+		return error;
+	
+	error = lyra_kbd_register_power_off(kbd);
+	if (error)
+		return error;
+	
+	serdev_device_set_client_ops(serdev, &lyra_kbd_serdev_ops);
+	error = devm_serdev_device_open(&serdev->dev, serdev);
+	if (error)
+		return error;
+	
+	of_property_read_u32(serdev->dev.of_node, "current-speed", &speed);
+	serdev_device_set_baudrate(serdev, speed);
+	serdev_device_set_flow_control(serdev, false);
+	error = serdev_device_set_parity(serdev, SERDEV_PARITY_NONE);
+	if (error)
+		return error;
+	
+	error = sysfs_create_group(&serdev->dev.kobj, &lyra_kbd_attr_group);
+	if (error) {
+		dev_err(&serdev->dev, "Failed to create sysfs group: %d\n", error);
+		return error;
+	}
+	
+	lyra_kbd_debugfs_init(kbd);
+	
+	/* Firmware announces itself at boot; ask again in case we missed it */
+	lyra_kbd_serdev_identify(kbd);
+	
+	dev_info(&serdev->dev, "Luckfox Lyra keyboard/mouse initialized (UART, %u baud)\n",
+		 speed);
+	
+	return 0;
+}
+
+static void lyra_kbd_serdev_remove(struct serdev_device *serdev)
+{
+	struct lyra_kbd_data *kbd = serdev_device_get_drvdata(serdev);
+	
+	debugfs_remove_recursive(kbd->debugfs);
+	sysfs_remove_group(&serdev->dev.kobj, &lyra_kbd_attr_group);
+}
+
+static const struct of_device_id lyra_kbd_serdev_of_match[] = {
+	{ .compatible = "luckfox,lyra-keyboard-uart" },
+	{ }
+};
+MODULE_DEVICE_TABLE(of, lyra_kbd_serdev_of_match);
+
+static struct serdev_device_driver lyra_kbd_serdev_driver = {
+	.driver = {
+		.name	= "lyra-serial-keyboard",
+		.of_match_table = lyra_kbd_serdev_of_match,
+	},
+	.probe		= lyra_kbd_serdev_probe,
+	.remove		= lyra_kbd_serdev_remove,
+};
+#endif /* CONFIG_SERIAL_DEV_BUS */
+
+static int __init lyra_kbd_init(void)
+{
+	int error;
+	
+	crc8_populate_msb(lyra_kbd_crc8_table, FRAME_CRC8_POLY);
+	lyra_kbd_debugfs_root = debugfs_create_dir("lyra_kbd", NULL);
+	
+	error = i2c_add_driver(&lyra_kbd_driver);
+	if (error)
+		goto err_debugfs;
+	
+#if IS_ENABLED(CONFIG_SERIAL_DEV_BUS)
+	error = serdev_device_driver_register(&lyra_kbd_serdev_driver);
+	if (error) {
+		i2c_del_driver(&lyra_kbd_driver);
+		goto err_debugfs;
+	}
+#endif
+	
+	return 0;
+	
+err_debugfs:
+	debugfs_remove_recursive(lyra_kbd_debugfs_root);
+	return error;
+}
+module_init(lyra_kbd_init);
+
+static void __exit lyra_kbd_exit(void)
+{
+#if IS_ENABLED(CONFIG_SERIAL_DEV_BUS)
+	serdev_device_driver_unregister(&lyra_kbd_serdev_driver);
+#endif
+	i2c_del_driver(&lyra_kbd_driver);
+	debugfs_remove_recursive(lyra_kbd_debugfs_root);
+}
+module_exit(lyra_kbd_exit);
 
 MODULE_AUTHOR("Luckfox");
 MODULE_DESCRIPTION("Luckfox Lyra I2C Keyboard and Mouse Driver");
@@ -0,0 +1,148 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Tracepoints for the Luckfox Lyra keyboard/mouse driver
+ *
+ * Copyright (C) 2025
+ */
+
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM lyra_kbd
+
+#if !defined(_LYRA_I2C_KEYBOARD_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _LYRA_I2C_KEYBOARD_TRACE_H
+
+#include <linux/device.h>
+#include <linux/tracepoint.h>
+
+/* One event byte taken from the FIFO register, an event frame or a UART report */
+TRACE_EVENT(lyra_kbd_fifo_read,
+	TP_PROTO(struct device *dev, u8 reg, u8 index, u8 raw),
+	TP_ARGS(dev, reg, index, raw),
+
+	TP_STRUCT__entry(
+		__string(dev, dev_name(dev))
+		__field(u8, reg)
+		__field(u8, index)
+		__field(u8, raw)
+	),
+
+	TP_fast_assign(
+		__assign_str(dev, dev_name(dev));
+		__entry->reg = reg;
+		__entry->index = index;
+		__entry->raw = raw;
+	),
+
+	TP_printk("%s reg=0x%02x [%u] raw=0x%02x type=%u code=%u",
+		  __get_str(dev), __entry->reg, __entry->index, __entry->raw,
+		  __entry->raw & 0x03, __entry->raw >> 2)
+);
+
+/* A verified event frame; lost is the number of frames skipped before it */
+TRACE_EVENT(lyra_kbd_frame,
+	TP_PROTO(struct device *dev, u8 seq, u8 count, u8 lost),
+	TP_ARGS(dev, seq, count, lost),
+
+	TP_STRUCT__entry(
+		__string(dev, dev_name(dev))
+		__field(u8, seq)
+		__field(u8, count)
+		__field(u8, lost)
+	),
+
+	TP_fast_assign(
+		__assign_str(dev, dev_name(dev));
+		__entry->seq = seq;
+		__entry->count = count;
+		__entry->lost = lost;
+	),
+
+	TP_printk("%s seq=%u count=%u lost=%u",
+		  __get_str(dev), __entry->seq, __entry->count, __entry->lost)
+);
+
+/*
+ * Firmware key code translated to the Linux key reported to input.
+ * Repeats (value 2) reuse the pressed key, so key_status is not read.
+ */
+TRACE_EVENT(lyra_kbd_key,
+	TP_PROTO(struct device *dev, u8 code, int value, u8 key_status,
+		 unsigned int key),
+	TP_ARGS(dev, code, value, key_status, key),
+
+	TP_STRUCT__entry(
+		__string(dev, dev_name(dev))
+		__field(u8, code)
+		__field(int, value)
+		__field(u8, key_status)
+		__field(unsigned int, key)
+	),
+
+	TP_fast_assign(
+		__assign_str(dev, dev_name(dev));
+		__entry->code = code;
+		__entry->value = value;
+		__entry->key_status = key_status;
+		__entry->key = key;
+	),
+
+	TP_printk("%s code=%u value=%d status=0x%02x key=%u",
+		  __get_str(dev), __entry->code, __entry->value,
+		  __entry->key_status, __entry->key)
+);
+
+/* Raw firmware deltas and the scaled values reported to input */
+TRACE_EVENT(lyra_kbd_mouse,
+	TP_PROTO(struct device *dev, s8 delta_x, s8 delta_y, s32 rel_x, s32 rel_y),
+	TP_ARGS(dev, delta_x, delta_y, rel_x, rel_y),
+
+	TP_STRUCT__entry(
+		__string(dev, dev_name(dev))
+		__field(s8, delta_x)
+		__field(s8, delta_y)
+		__field(s32, rel_x)
+		__field(s32, rel_y)
+	),
+
+	TP_fast_assign(
+		__assign_str(dev, dev_name(dev));
+		__entry->delta_x = delta_x;
+		__entry->delta_y = delta_y;
+		__entry->rel_x = rel_x;
+		__entry->rel_y = rel_y;
+	),
+
+	TP_printk("%s delta=%d,%d rel=%d,%d",
+		  __get_str(dev), __entry->delta_x, __entry->delta_y,
+		  __entry->rel_x, __entry->rel_y)
+);
+
+/* A failed register or block transfer */
+TRACE_EVENT(lyra_kbd_i2c_error,
+	TP_PROTO(struct device *dev, u8 reg, int error),
+	TP_ARGS(dev, reg, error),
+
+	TP_STRUCT__entry(
+		__string(dev, dev_name(dev))
+		__field(u8, reg)
+		__field(int, error)
+	),
+
+	TP_fast_assign(
+		__assign_str(dev, dev_name(dev));
+		__entry->reg = reg;
+		__entry->error = error;
+	),
+
+	TP_printk("%s reg=0x%02x error=%d",
+		  __get_str(dev), __entry->reg, __entry->error)
+);
+
+#endif /* _LYRA_I2C_KEYBOARD_TRACE_H */
+
+/* This part must be outside protection */
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE lyra_i2c_keyboard_trace
+#include <trace/define_trace.h>
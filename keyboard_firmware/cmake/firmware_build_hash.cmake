@@ -0,0 +1,26 @@
+# Write the git revision to a header for the I2C identification registers.
+# Runs on every build; the header is only rewritten when the hash changes,
+# so an unchanged revision does not trigger a rebuild.
+#
+# Usage: cmake -DSOURCE_DIR=<repo> -DOUTPUT=<header> -P firmware_build_hash.cmake
+
+execute_process(
+    COMMAND git rev-parse --short=8 HEAD
+    WORKING_DIRECTORY ${SOURCE_DIR}
+    OUTPUT_VARIABLE FIRMWARE_GIT_HASH
+    OUTPUT_STRIP_TRAILING_WHITESPACE
+    RESULT_VARIABLE FIRMWARE_GIT_RESULT
+    ERROR_QUIET
+)
+if(NOT FIRMWARE_GIT_RESULT EQUAL 0 OR NOT FIRMWARE_GIT_HASH)
+    set(FIRMWARE_GIT_HASH 00000000)
+endif()
+
+set(CONTENT "// Generated by cmake/firmware_build_hash.cmake, do not edit\n#define FIRMWARE_BUILD_HASH 0x${FIRMWARE_GIT_HASH}u\n")
+
+if(EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} PREVIOUS)
+endif()
+if(NOT "${PREVIOUS}" STREQUAL "${CONTENT}")
+    file(WRITE ${OUTPUT} "${CONTENT}")
+endif()
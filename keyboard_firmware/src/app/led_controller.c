@@ -15,6 +15,14 @@ static bool pulse_active = false;
 static uint32_t pulse_end_ms = 0;
 static bool blink_on = false;
 static uint32_t next_blink_toggle_ms = 0;
+static led_palette_t palette = {
+    .idle = CONFIG_COLOR_IDLE,
+    .power = CONFIG_COLOR_POWER,
+    .pulse = CONFIG_COLOR_PULSE,
+    .mod_fn = CONFIG_COLOR_MOD_FN,
+    .mod_alt = CONFIG_COLOR_MOD_ALT,
+    .mod_shift = CONFIG_COLOR_MOD_SHIFT,
+};
 
 static inline uint8_t color_r(uint32_t color) { return (color >> 16) & 0xFF; }
 static inline uint8_t color_g(uint32_t color) { return (color >> 8) & 0xFF; }
@@ -25,23 +33,23 @@ static void set_color(uint32_t color) {
 }
 
 static void set_idle(void) {
-    set_color(CONFIG_COLOR_IDLE);
+    set_color(palette.idle);
 }
 
 static void set_modifier(int8_t modifier_index) {
     uint32_t color;
     switch (modifier_index) {
         case 0:  // FN
-            color = CONFIG_COLOR_MOD_FN;
+            color = palette.mod_fn;
             break;
         case 1:  // ALT
-            color = CONFIG_COLOR_MOD_ALT;
+            color = palette.mod_alt;
             break;
         case 2:  // SHIFT
-            color = CONFIG_COLOR_MOD_SHIFT;
+            color = palette.mod_shift;
             break;
         default:
-            color = CONFIG_COLOR_IDLE;
+            color = palette.idle;
             break;
     }
     set_color(color);
@@ -49,14 +57,14 @@ static void set_modifier(int8_t modifier_index) {
 
 static void set_power(bool on) {
     if (on) {
-        set_color(CONFIG_COLOR_POWER);
+        set_color(palette.power);
     } else {
         set_idle();
     }
 }
 
 static void set_pulse(void) {
-    set_color(CONFIG_COLOR_PULSE);
+    set_color(palette.pulse);
 }
 
 static void refresh(uint32_t now_ms) {
@@ -97,6 +105,10 @@ void led_controller_init(uint32_t led_pin) {
     set_idle();
 }
 
+void led_controller_set_palette(const led_palette_t *colors) {
+    palette = *colors;
+}
+
 void led_controller_set_power_pressed(bool pressed) {
     power_pressed = pressed;
     if (pressed && next_blink_toggle_ms == 0) {
@@ -118,3 +130,7 @@ void led_controller_pulse_short_press(uint32_t now_ms) {
 void led_controller_tick(uint32_t now_ms) {
     refresh(now_ms);
 }
+
+void led_controller_sleep(void) {
+    led_off();
+}
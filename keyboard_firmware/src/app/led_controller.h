@@ -4,10 +4,22 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+// LED colors as 0x00RRGGBB (defaults from config.h)
+typedef struct {
+    uint32_t idle;
+    uint32_t power;
+    uint32_t pulse;
+    uint32_t mod_fn;
+    uint32_t mod_alt;
+    uint32_t mod_shift;
+} led_palette_t;
+
 void led_controller_init(uint32_t led_pin);
+void led_controller_set_palette(const led_palette_t *palette);
 void led_controller_set_power_pressed(bool pressed);
 void led_controller_set_modifier(int8_t modifier_index);  // -1 for none, 0-2 for FN/ALT/SHIFT
 void led_controller_pulse_short_press(uint32_t now_ms);
 void led_controller_tick(uint32_t now_ms);
+void led_controller_sleep(void);  // LED off until the next tick
 
 #endif  // LED_CONTROLLER_H
@@ -3,23 +3,186 @@
 #include "../input/digital_mouse.h"
 #include "../input/fn_keys.h"
 #include "../hardware/i2c_slave.h"
-#include "../input/key_fifo.h"
+#if defined(CONFIG_TRANSPORT_UART)
+#include "../hardware/uart_transport.h"
+#elif defined(CONFIG_TRANSPORT_USB_HID)
+#include "../hardware/usb_hid.h"
+#endif
+#include "../input/event_bus.h"
 #include "led_controller.h"
 #include "../input/matrix_scanner.h"
 #include "../input/modifier_manager.h"
 #include "pico/stdlib.h"
 #include "../hardware/power_latch.h"
+#include "../hardware/battery_monitor.h"
+#ifdef CONFIG_LOW_POWER
+#include "../hardware/low_power.h"
+#endif
 #include "../input/switch_tracker.h"
+#include "../input/typematic.h"
 #include "../core/tick.h"
+#include "../config/runtime_config.h"
+
+// Routing context for events published on the event bus
+typedef struct {
+    modifier_manager_t *modifier_manager;
+    digital_mouse_t *digital_mouse;
+    typematic_t *typematic;
+    bool had_key_event;
+    bool had_mouse_event;
+} input_router_t;
+
+// Event bus filter: updates modifier and mouse state in place and decides
+// which events are forwarded to the host
+static bool route_input_event(void *ctx, const key_event_t *event) {
+    input_router_t *router = (input_router_t *)ctx;
+
+    if (event->source == EVENT_SOURCE_FN) {
+        uint8_t fn_index = event->key_code - FN_KEY_CODE_BASE;
+
+        // FN9-FN12 control mouse movement (don't go to FIFO)
+        if (fn_index >= FN_KEY_FN9 && fn_index <= FN_KEY_FN12) {
+            bool pressed = (event->type == KEY_EVENT_PRESS || event->type == KEY_EVENT_HOLD);
+            digital_mouse_update_button(router->digital_mouse, fn_index, pressed);
+            router->had_mouse_event = true;
+            return false;
+        }
+
+        // FN1-FN6 and FN8 are keyboard/action keys
+        // Notify modifier manager that a non-modifier key was pressed (deactivates sticky modifiers)
+        if (event->type == KEY_EVENT_PRESS) {
+            modifier_manager_on_other_key_press(router->modifier_manager);
+            typematic_key_down(router->typematic, event->key_code, event->source, event->time_ms);
+        }
+    } else {
+        bool is_modifier = false;
+
+        // Check if this is a modifier key
+        if (event->type == KEY_EVENT_PRESS) {
+            is_modifier = modifier_manager_on_key_press(router->modifier_manager,
+                                                        event->key_code, event->time_ms);
+        } else if (event->type == KEY_EVENT_RELEASE) {
+            is_modifier = modifier_manager_on_key_release(router->modifier_manager,
+                                                          event->key_code, event->time_ms);
+        }
+
+        // If not a modifier, notify modifier manager of other key press
+        if (!is_modifier && event->type == KEY_EVENT_PRESS) {
+            modifier_manager_on_other_key_press(router->modifier_manager);
+            typematic_key_down(router->typematic, event->key_code, event->source, event->time_ms);
+        }
+    }
 
-static void process_switch_event(switch_event_t event, uint32_t now_ms) {
+    // Stop repeating on release
+    if (event->type == KEY_EVENT_RELEASE) {
+        typematic_key_up(router->typematic, event->key_code);
+    }
+
+    router->had_key_event = true;
+    return true;
+}
+
+// Modules whose parameters can be changed through the configuration page
+typedef struct {
+    button_t *power_button;
+    matrix_scanner_t *matrix_scanner;
+#ifdef CONFIG_EXPANSION_ROW_GPIOS
+    matrix_scanner_t *expansion_scanner;
+#endif
+    fn_keys_t *fn_keys;
+    modifier_manager_t *modifier_manager;
+    digital_mouse_t *digital_mouse;
+    typematic_t *typematic;
+    event_bus_t *event_bus;
+} tunable_modules_t;
+
+static void apply_runtime_config(const tunable_modules_t *modules, const runtime_config_t *config) {
+    modules->power_button->debounce_ms = config->debounce_ms;
+    matrix_scanner_set_debounce(modules->matrix_scanner, config->debounce_ms);
+#ifdef CONFIG_EXPANSION_ROW_GPIOS
+    matrix_scanner_set_debounce(modules->expansion_scanner, config->debounce_ms);
+#endif
+    fn_keys_set_debounce(modules->fn_keys, config->debounce_ms);
+    modifier_manager_set_double_press_window(modules->modifier_manager,
+                                             config->double_press_window_ms);
+    digital_mouse_set_interval(modules->digital_mouse, config->mouse_update_interval_ms);
+    typematic_set_params(modules->typematic, config->typematic_delay_ms,
+                         config->typematic_interval_ms);
+
+    const led_palette_t palette = {
+        .idle = config->color_idle,
+        .power = config->color_power,
+        .pulse = config->color_pulse,
+        .mod_fn = config->color_mod_fn,
+        .mod_alt = config->color_mod_alt,
+        .mod_shift = config->color_mod_shift,
+    };
+    led_controller_set_palette(&palette);
+
+    i2c_slave_set_interrupt_moderation(config->irq_coalesce_ms,
+                                       config->mouse_update_interval_ms * IRQ_MOUSE_COALESCE_STEPS,
+                                       config->irq_watermark, config->irq_immediate_mask);
+    event_bus_set_watermark(modules->event_bus, config->fifo_watermark);
+}
+
+// Execute a command written to the configuration control register.
+// Runs in the main loop so flash writes never happen in IRQ context.
+static void process_config_command(uint8_t command, const tunable_modules_t *modules,
+                                   runtime_config_t *active, runtime_config_t *staging) {
+    uint8_t status = I2C_CONFIG_STATUS_OK;
+
+    switch (command) {
+        case I2C_CONFIG_CMD_APPLY:
+        case I2C_CONFIG_CMD_COMMIT:
+            if (!runtime_config_validate(staging)) {
+                status = I2C_CONFIG_STATUS_ERR_INVALID;
+                break;
+            }
+            *active = *staging;
+            apply_runtime_config(modules, active);
+            if (command == I2C_CONFIG_CMD_COMMIT && !runtime_config_save(active)) {
+                status = I2C_CONFIG_STATUS_ERR_FLASH;
+            }
+            break;
+        case I2C_CONFIG_CMD_REVERT:
+            *staging = *active;
+            break;
+        case I2C_CONFIG_CMD_DEFAULTS:
+            runtime_config_defaults(staging);
+            break;
+        default:
+            status = I2C_CONFIG_STATUS_ERR_INVALID;
+            break;
+    }
+
+    i2c_slave_set_config_status(status);
+}
+
+// Shutdown requested by a long press, waiting for the host to be ready
+typedef struct {
+    bool pending;
+    uint32_t deadline_ms;
+} shutdown_request_t;
+
+static void process_switch_event(switch_event_t event, uint32_t now_ms,
+                                 shutdown_request_t *shutdown, uint16_t grace_ms) {
     switch (event) {
         case SWITCH_EVENT_FIRST_PRESS:
             break;
         case SWITCH_EVENT_LONG_PRESS:
-            power_latch_open();
+            i2c_slave_report_power_events(I2C_POWER_STATUS_LONG_PRESS);
+            i2c_slave_set_interrupt_flags(I2C_INT_POWER_BUTTON);
+            if (grace_ms == 0) {
+                power_latch_open();
+            } else if (!shutdown->pending) {
+                // Give the host time to sync and power off before the latch opens
+                shutdown->pending = true;
+                shutdown->deadline_ms = now_ms + grace_ms;
+            }
             break;
         case SWITCH_EVENT_SHORT_PRESS:
+            i2c_slave_report_power_events(I2C_POWER_STATUS_SHORT_PRESS);
+            i2c_slave_set_interrupt_flags(I2C_INT_POWER_BUTTON);
             led_controller_pulse_short_press(now_ms);
             break;
         case SWITCH_EVENT_NONE:
@@ -28,19 +191,132 @@ static void process_switch_event(switch_event_t event, uint32_t now_ms) {
     }
 }
 
+// Release the latch once the host writes I2C_POWER_CMD_OFF or the grace
+// time of a pending request runs out. The host may also power off on its own.
+static void service_shutdown(shutdown_request_t *shutdown, uint32_t now_ms, uint8_t power_command) {
+    bool expired = shutdown->pending && (int32_t)(now_ms - shutdown->deadline_ms) >= 0;
+
+    if (power_command == I2C_POWER_CMD_OFF || expired) {
+        shutdown->pending = false;
+        power_latch_open();
+    }
+}
+
+#ifdef CONFIG_LOW_POWER
+// Low-power mode bookkeeping, reported in the I2C low-power block
+typedef struct {
+    bool requested;             // Host wrote I2C_POWER_CMD_SLEEP
+    uint32_t last_activity_ms;  // Input, host command or wake
+    uint16_t count;
+    uint8_t wake_source;
+    uint16_t resume_us;
+    uint16_t first_key_us;
+    uint32_t wake_us;
+    bool awaiting_first_key;    // Woken by a key, no key event scanned yet
+} sleep_state_t;
+
+static uint16_t saturate_u16(uint32_t value) {
+    return value > 0xFFFF ? 0xFFFF : (uint16_t)value;
+}
+
+static void report_sleep(const sleep_state_t *sleep, bool asleep) {
+    i2c_slave_update_sleep(asleep, sleep->count, sleep->wake_source, sleep->resume_us,
+                           sleep->first_key_us);
+}
+
+// Sleep until a key, the power button or a host command. Returns false
+// without sleeping while a key is held: its level would end the sleep at once.
+static bool enter_low_power(const tunable_modules_t *modules, sleep_state_t *sleep,
+                            uint32_t now_ms) {
+    uint32_t key_mask = matrix_scanner_arm_wake(modules->matrix_scanner, true);
+#ifdef CONFIG_EXPANSION_ROW_GPIOS
+    key_mask |= matrix_scanner_arm_wake(modules->expansion_scanner, true);
+#endif
+    for (int i = 0; i < FN_KEY_COUNT; i++) {
+        key_mask |= 1u << modules->fn_keys->gpios[i];
+    }
+    uint32_t power_mask = 1u << modules->power_button->pin;
+
+    bool slept = !low_power_wake_pending(key_mask | power_mask);
+    if (!slept) {
+        sleep->last_activity_ms = now_ms;
+    } else {
+        sleep->count++;
+        report_sleep(sleep, true);
+
+        // Quiesce everything clocked from the PLLs
+        led_controller_sleep();
+        battery_monitor_suspend();
+        tick_service_suspend();
+
+        low_power_wake_t wake;
+        low_power_sleep(key_mask | power_mask, i2c_slave_has_pending_command, &wake);
+
+        tick_service_resume();
+        battery_monitor_resume();
+
+        if (wake.wake_gpios & power_mask) {
+            sleep->wake_source = I2C_WAKE_SOURCE_POWER;
+        } else if (wake.wake_gpios != 0) {
+            sleep->wake_source = I2C_WAKE_SOURCE_KEY;
+        } else {
+            sleep->wake_source = I2C_WAKE_SOURCE_HOST;
+        }
+        sleep->resume_us = saturate_u16(wake.resume_us);
+        sleep->first_key_us = 0;
+        sleep->wake_us = wake.wake_us;
+        sleep->awaiting_first_key = sleep->wake_source == I2C_WAKE_SOURCE_KEY;
+        sleep->last_activity_ms = tick_now_ms();
+        report_sleep(sleep, false);
+    }
+
+    matrix_scanner_arm_wake(modules->matrix_scanner, false);
+#ifdef CONFIG_EXPANSION_ROW_GPIOS
+    matrix_scanner_arm_wake(modules->expansion_scanner, false);
+#endif
+    return slept;
+}
+#endif
+
 int main() {
     stdio_init_all();
 
+#if defined(CONFIG_TRANSPORT_UART)
+    // Initialize UART transport first (GPIOs 0 and 1); the I2C register
+    // map is still maintained and streamed over the UART
+    uart_transport_init();
+#elif defined(CONFIG_TRANSPORT_USB_HID)
+    // Initialize the USB device; the I2C register map is still maintained
+    // and translated into HID reports
+    usb_hid_init();
+#else
     // Initialize I2C slave first (GPIOs 0 and 1)
     i2c_slave_init(CONFIG_I2C_SLAVE_ADDRESS, CONFIG_I2C_INTERRUPT_GPIO);
+#endif
+
+    // Load persisted runtime configuration (defaults from config.h otherwise)
+    runtime_config_t config;
+    runtime_config_load(&config);
+
+    // Expose a staging copy as the I2C configuration page
+    runtime_config_t config_staging = config;
+    i2c_slave_set_config_page((uint8_t *)&config_staging, sizeof(config_staging));
 
     // Initialize power latch and start with closed latch
     power_latch_init(CONFIG_POWER_LATCH_GPIO);
     power_latch_close();
 
+    // Start battery sampling (ADC + DMA ring, runs without the CPU)
+    battery_monitor_init(CONFIG_BATTERY_ADC_GPIO);
+
+#ifdef CONFIG_LOW_POWER
+    // Stop the clock domains the I2C build does not use
+    low_power_init();
+#endif
+
     // Initialize power button
     button_t power_button = {0};
-    button_init(&power_button, CONFIG_POWER_LATCH_GPIO, false, DEBOUNCE_MS, true, false);
+    button_init(&power_button, CONFIG_POWER_LATCH_GPIO, false, config.debounce_ms, true, false);
 
     // Initialize LED controller
     led_controller_init(CONFIG_LED_GPIO);
@@ -52,10 +328,10 @@ int main() {
     switch_tracker_t tracker;
     switch_tracker_init(&tracker, STARTUP_WINDOW_MS, FIRST_PRESS_HOLD_MS, LONG_PRESS_MS);
 
-    // Initialize key FIFO
-    key_fifo_t key_fifo;
-    key_fifo_init(&key_fifo);
-    i2c_slave_set_fifo(&key_fifo);
+    // Initialize event bus shared by all input sources and the I2C slave
+    event_bus_t event_bus;
+    event_bus_init(&event_bus);
+    i2c_slave_set_event_bus(&event_bus);
 
     // Initialize matrix scanner
     const uint8_t row_gpios[] = {
@@ -67,8 +343,36 @@ int main() {
         CONFIG_COL_D_GPIO, CONFIG_COL_E_GPIO, CONFIG_COL_F_GPIO,
         CONFIG_COL_G_GPIO
     };
+    const matrix_scanner_config_t matrix_config = {
+        .row_gpios = row_gpios,
+        .col_gpios = col_gpios,
+        .rows = MATRIX_ROWS,
+        .cols = MATRIX_COLS,
+        .key_code_base = 0,
+        .source = EVENT_SOURCE_MATRIX,
+        .debounce_ms = config.debounce_ms,
+        .scan_interval_ms = 0,
+    };
     matrix_scanner_t matrix_scanner;
-    matrix_scanner_init(&matrix_scanner, row_gpios, col_gpios, DEBOUNCE_MS);
+    matrix_scanner_init(&matrix_scanner, &matrix_config, &event_bus);
+
+#ifdef CONFIG_EXPANSION_ROW_GPIOS
+    // Initialize expansion matrix (independent instance, same event bus)
+    const uint8_t expansion_row_gpios[] = CONFIG_EXPANSION_ROW_GPIOS;
+    const uint8_t expansion_col_gpios[] = CONFIG_EXPANSION_COL_GPIOS;
+    const matrix_scanner_config_t expansion_config = {
+        .row_gpios = expansion_row_gpios,
+        .col_gpios = expansion_col_gpios,
+        .rows = sizeof(expansion_row_gpios),
+        .cols = sizeof(expansion_col_gpios),
+        .key_code_base = CONFIG_EXPANSION_KEY_CODE_BASE,
+        .source = EVENT_SOURCE_EXPANSION,
+        .debounce_ms = config.debounce_ms,
+        .scan_interval_ms = CONFIG_EXPANSION_SCAN_INTERVAL_MS,
+    };
+    matrix_scanner_t expansion_scanner;
+    matrix_scanner_init(&expansion_scanner, &expansion_config, &event_bus);
+#endif
 
     // Initialize FN keys
     const uint8_t fn_gpios[] = {
@@ -77,7 +381,7 @@ int main() {
         CONFIG_FN10_GPIO, CONFIG_FN11_GPIO, CONFIG_FN12_GPIO
     };
     fn_keys_t fn_keys;
-    fn_keys_init(&fn_keys, fn_gpios, DEBOUNCE_MS);
+    fn_keys_init(&fn_keys, fn_gpios, config.debounce_ms, &event_bus);
 
     // Initialize modifier manager
     modifier_manager_t modifier_manager;
@@ -85,11 +389,44 @@ int main() {
     uint8_t alt_key_code = matrix_get_key_code(MODIFIER_ALT_ROW, MODIFIER_ALT_COL);
     uint8_t shift_key_code = matrix_get_key_code(MODIFIER_SHIFT_ROW, MODIFIER_SHIFT_COL);
     modifier_manager_init(&modifier_manager, fn_key_code, alt_key_code, shift_key_code,
-                         MODIFIER_DOUBLE_PRESS_WINDOW_MS);
+                         config.double_press_window_ms);
 
     // Initialize digital mouse
     digital_mouse_t digital_mouse;
-    digital_mouse_init(&digital_mouse, MOUSE_UPDATE_INTERVAL_MS);
+    digital_mouse_init(&digital_mouse, config.mouse_update_interval_ms);
+
+    // Initialize typematic repeat for non-modifier keys
+    typematic_t typematic;
+    typematic_init(&typematic, config.typematic_delay_ms, config.typematic_interval_ms,
+                   &event_bus);
+
+    // Route bus events through the modifier manager, digital mouse and typematic
+    input_router_t router = {
+        .modifier_manager = &modifier_manager,
+        .digital_mouse = &digital_mouse,
+        .typematic = &typematic,
+    };
+    event_bus_set_filter(&event_bus, route_input_event, &router);
+
+    // Apply the loaded configuration (covers the LED palette)
+    const tunable_modules_t modules = {
+        .power_button = &power_button,
+        .matrix_scanner = &matrix_scanner,
+#ifdef CONFIG_EXPANSION_ROW_GPIOS
+        .expansion_scanner = &expansion_scanner,
+#endif
+        .fn_keys = &fn_keys,
+        .modifier_manager = &modifier_manager,
+        .digital_mouse = &digital_mouse,
+        .typematic = &typematic,
+        .event_bus = &event_bus,
+    };
+    apply_runtime_config(&modules, &config);
+
+    shutdown_request_t shutdown = {0};
+#ifdef CONFIG_LOW_POWER
+    sleep_state_t sleep = {0};
+#endif
 
     // Track previous states for interrupt generation
     bool prev_power_pressed = false;
@@ -109,81 +446,41 @@ int main() {
                 prev_power_pressed = power_pressed;
             }
 
-            // Update LED for power button state
-            led_controller_set_power_pressed(power_pressed);
+            // Update LED for power button state, held while a shutdown is pending
+            led_controller_set_power_pressed(power_pressed || shutdown.pending);
 
             // Process power button switch tracking
             switch_event_t event = switch_tracker_tick(&tracker, power_pressed, now_ms);
-            process_switch_event(event, now_ms);
+            process_switch_event(event, now_ms, &shutdown, config.shutdown_grace_ms);
+            uint8_t power_command = i2c_slave_take_power_command();
+            service_shutdown(&shutdown, now_ms, power_command);
 
-            // Scan matrix keyboard
-            matrix_scanner_tick(&matrix_scanner, now_ms);
+            // Expose the debounced level and latch state in the power status register
+            i2c_slave_update_power(power_pressed, power_latch_is_closed(), shutdown.pending);
 
-            // Scan FN keys
+            // Scan inputs; events are routed as they are published
+            router.had_key_event = false;
+            router.had_mouse_event = false;
+            matrix_scanner_tick(&matrix_scanner, now_ms);
+#ifdef CONFIG_EXPANSION_ROW_GPIOS
+            matrix_scanner_tick(&expansion_scanner, now_ms);
+#endif
             fn_keys_tick(&fn_keys, now_ms);
+            typematic_tick(&typematic, now_ms);
 
-            // Process matrix events
-            key_event_t matrix_event;
-            bool had_matrix_event = false;
-            while (matrix_scanner_get_event(&matrix_scanner, &matrix_event)) {
-                had_matrix_event = true;
-                bool is_modifier = false;
-
-                // Check if this is a modifier key
-                if (matrix_event.type == KEY_EVENT_PRESS) {
-                    is_modifier = modifier_manager_on_key_press(&modifier_manager, 
-                                                                matrix_event.key_code, now_ms);
-                } else if (matrix_event.type == KEY_EVENT_RELEASE) {
-                    is_modifier = modifier_manager_on_key_release(&modifier_manager, 
-                                                                  matrix_event.key_code, now_ms);
-                }
-
-                // If not a modifier, notify modifier manager of other key press
-                if (!is_modifier && matrix_event.type == KEY_EVENT_PRESS) {
-                    modifier_manager_on_other_key_press(&modifier_manager);
-                }
-
-                // Push event to FIFO
-                key_fifo_push(&key_fifo, matrix_event.type, matrix_event.key_code);
-            }
-            
-            // Set key event interrupt flag if any matrix events occurred
-            if (had_matrix_event) {
+            // Set key event interrupt flag for all keyboard events (press, hold, release)
+            if (router.had_key_event) {
                 i2c_slave_set_interrupt_flags(I2C_INT_KEY_EVENT);
             }
 
-            // Process FN key events
-            fn_event_t fn_event;
-            bool had_mouse_event = false;
-            bool had_fn_keyboard_event = false;
-            while (fn_keys_get_event(&fn_keys, &fn_event)) {
-                uint8_t fn_index = fn_event.key_code - FN_KEY_CODE_BASE;
-                
-                // FN9-FN12 control mouse movement (don't go to FIFO)
-                if (fn_index >= FN_KEY_FN9 && fn_index <= FN_KEY_FN12) {
-                    bool pressed = (fn_event.type == FN_EVENT_PRESS || fn_event.type == FN_EVENT_HOLD);
-                    digital_mouse_update_button(&digital_mouse, fn_index, pressed);
-                    had_mouse_event = true;
-                    // Don't push mouse movement keys to FIFO
-                    continue;
-                }
-                
-                // FN1-FN6 and FN8 are keyboard/action keys
-                had_fn_keyboard_event = true;  // Track that we have FN keyboard events
-                
-                // Notify modifier manager that a non-modifier key was pressed (deactivates sticky modifiers)
-                if (fn_event.type == FN_EVENT_PRESS) {
-                    modifier_manager_on_other_key_press(&modifier_manager);
-                }
-                
-                // Push to FIFO
-                key_fifo_push(&key_fifo, fn_event.type, fn_event.key_code);
-            }
-            
-            // Set key event interrupt flag for all FN keyboard events (press, hold, release)
-            if (had_fn_keyboard_event) {
-                i2c_slave_set_interrupt_flags(I2C_INT_KEY_EVENT);
+#ifdef CONFIG_LOW_POWER
+            // Resume latency as seen by the user: wake to the first debounced key
+            if (sleep.awaiting_first_key && router.had_key_event) {
+                sleep.first_key_us = saturate_u16(time_us_32() - sleep.wake_us);
+                sleep.awaiting_first_key = false;
+                report_sleep(&sleep, false);
             }
+#endif
 
             // Update digital mouse position
             digital_mouse_tick(&digital_mouse, now_ms);
@@ -201,33 +498,97 @@ int main() {
                 prev_modifier_mask = modifier_mask;
             }
 
+            // Report matrix rollover (ghost suppression) status
+            bool ghosting = matrix_scanner_is_ghosting(&matrix_scanner);
+            uint32_t ghost_count = matrix_scanner_get_ghost_count(&matrix_scanner);
+#ifdef CONFIG_EXPANSION_ROW_GPIOS
+            ghosting |= matrix_scanner_is_ghosting(&expansion_scanner);
+            ghost_count += matrix_scanner_get_ghost_count(&expansion_scanner);
+#endif
+            i2c_slave_update_rollover(ghosting, ghost_count);
+
+            // Publish a new battery reading (the filter runs every few hundred ms)
+            if (battery_monitor_tick(now_ms)) {
+                uint16_t battery_mv = battery_monitor_get_mv();
+                uint8_t battery_flags = I2C_BATTERY_FLAG_VALID;
+                if (battery_monitor_is_present()) {
+                    battery_flags |= I2C_BATTERY_FLAG_PRESENT;
+                    if (battery_mv < BATTERY_LOW_MV) {
+                        battery_flags |= I2C_BATTERY_FLAG_LOW;
+                    }
+                }
+                i2c_slave_update_battery(battery_mv, battery_monitor_get_percent(), battery_flags,
+                                         battery_monitor_get_raw());
+            }
+
             int8_t mouse_x = digital_mouse_get_and_clear_x(&digital_mouse);
             int8_t mouse_y = digital_mouse_get_and_clear_y(&digital_mouse);
             i2c_slave_update_mouse(mouse_x, mouse_y);
             
             // Set mouse interrupt flag if movement occurred
-            if (had_mouse_event || mouse_x != 0 || mouse_y != 0) {
+            if (router.had_mouse_event || mouse_x != 0 || mouse_y != 0) {
                 i2c_slave_set_interrupt_flags(I2C_INT_MOUSE_EVENT);
             }
             
             // Check for FIFO overflow and set interrupt flag
-            if (key_fifo_check_and_clear_overflow(&key_fifo)) {
+            if (event_bus_check_and_clear_overflow(&event_bus)) {
                 i2c_slave_set_interrupt_flags(I2C_INT_FIFO_OVERFLOW);
             }
 
-            // Notify I2C if events are available
-            if (!key_fifo_is_empty(&key_fifo)) {
-                i2c_slave_notify_events_available();
-            } else {
-                i2c_slave_check_and_clear_interrupt();
+            // Warn the host before the FIFO overflows
+            if (event_bus_check_and_clear_watermark(&event_bus)) {
+                i2c_slave_set_interrupt_flags(I2C_INT_FIFO_WATERMARK);
+            }
+
+#if defined(CONFIG_TRANSPORT_UART)
+            // Push pending state to the host
+            uart_transport_tick();
+#elif defined(CONFIG_TRANSPORT_USB_HID)
+            // Queue HID reports for the next USB frame
+            usb_hid_tick();
+#else
+            // Assert/release the interrupt line (moderated)
+            i2c_slave_service_interrupt(now_ms);
+#endif
+
+            // Execute pending configuration page commands
+            uint8_t config_command = i2c_slave_take_config_command();
+            if (config_command != I2C_CONFIG_CMD_NONE) {
+                process_config_command(config_command, &modules, &config, &config_staging);
             }
 
             // Update LED controller based on active modifier
             int8_t active_mod = modifier_manager_get_active_for_led(&modifier_manager);
             led_controller_set_modifier(active_mod);
             led_controller_tick(now_ms);
+
+#ifdef CONFIG_LOW_POWER
+            // Enter low-power mode on host request or after the idle timeout,
+            // once the host has drained every event and nothing is pending
+            if (power_command == I2C_POWER_CMD_SLEEP) {
+                sleep.requested = true;
+            } else if (power_command != I2C_POWER_CMD_NONE) {
+                sleep.requested = false;
+            }
+            if (router.had_key_event || router.had_mouse_event || power_pressed ||
+                config_command != I2C_CONFIG_CMD_NONE || power_command != I2C_POWER_CMD_NONE) {
+                sleep.last_activity_ms = now_ms;
+            }
+            bool idle = config.idle_sleep_ms != 0 &&
+                        now_ms - sleep.last_activity_ms >= config.idle_sleep_ms;
+            bool drained = i2c_slave_get_interrupt_flags() == 0 && event_bus_is_empty(&event_bus);
+            if ((sleep.requested || idle) && drained && !shutdown.pending &&
+                enter_low_power(&modules, &sleep, now_ms)) {
+                sleep.requested = false;
+            }
+#endif
         }
 
+#ifdef CONFIG_TRANSPORT_USB_HID
+        // USB control requests and endpoint completions are serviced outside the tick
+        usb_hid_task();
+#endif
+
         tight_loop_contents();
     }
 
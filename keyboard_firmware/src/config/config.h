@@ -11,6 +11,27 @@
 #define CONFIG_I2C_SLAVE_ADDRESS 0x20
 #define CONFIG_I2C_INTERRUPT_GPIO 26  // Interrupt output for event signaling
 
+// Battery monitor: cell voltage through a resistor divider on the only free
+// ADC input (GP27 = ADC1)
+#define CONFIG_BATTERY_ADC_GPIO 27
+#define BATTERY_DIVIDER_RATIO_X100 200   // Battery voltage / ADC pin voltage, x100
+#define BATTERY_SAMPLE_RATE_HZ 1000      // Free-running ADC rate (DMA, no CPU)
+#define BATTERY_UPDATE_INTERVAL_MS 250   // Averaging and filter update period
+#define BATTERY_PRESENT_MIN_MV 2500      // Lower readings mean no cell / floating input
+#define BATTERY_LOW_MV 3500              // Low battery flag threshold
+
+// Host transport: the I2C slave by default. Building with
+// CONFIG_TRANSPORT_UART (CMake option KEYBOARD_TRANSPORT_UART) streams the
+// same register map over UART0 on GP0/GP1 instead.
+// CONFIG_TRANSPORT_USB_HID (CMake option KEYBOARD_TRANSPORT_USB_HID) presents
+// the keyboard as a USB HID keyboard + mouse; the keymap lives in usb_hid.c.
+
+// Low-power mode wakes on an I2C address match, so it is only available with
+// the I2C slave transport
+#if !defined(CONFIG_TRANSPORT_UART) && !defined(CONFIG_TRANSPORT_USB_HID)
+#define CONFIG_LOW_POWER 1
+#endif
+
 // Matrix keyboard rows (6 rows)
 #define CONFIG_ROW_1_GPIO 7
 #define CONFIG_ROW_2_GPIO 8
@@ -41,6 +62,14 @@
 #define CONFIG_FN11_GPIO 24
 #define CONFIG_FN12_GPIO 25
 
+// Optional expansion matrix (e.g. number pad on the free GPIO header).
+// Uncomment and fill in the pin lists to scan a second matrix; its key
+// codes start after the FN keys (53) and must stay below 64.
+// #define CONFIG_EXPANSION_ROW_GPIOS { ... }
+// #define CONFIG_EXPANSION_COL_GPIOS { ... }
+#define CONFIG_EXPANSION_KEY_CODE_BASE 53
+#define CONFIG_EXPANSION_SCAN_INTERVAL_MS 5
+
 // Modifier key positions in matrix (from keyboard_layout.json)
 // C6 = FN (col 2, row 5)
 // C5 = ALT (col 2, row 4)
@@ -65,7 +94,18 @@
 #define STARTUP_WINDOW_MS 1000
 #define FIRST_PRESS_HOLD_MS 500
 #define LONG_PRESS_MS 3000
+#define SHUTDOWN_GRACE_MS 20000     // Long press to latch release while the host shuts down (0 = at once)
+#define IDLE_SLEEP_MS 10000         // Inactivity before low-power mode, I2C build only (0 = host request only)
 #define MODIFIER_DOUBLE_PRESS_WINDOW_MS 300
 #define MOUSE_UPDATE_INTERVAL_MS 20
+#define TYPEMATIC_DELAY_MS 500      // Hold time before the first repeat
+#define TYPEMATIC_INTERVAL_MS 33    // Repeat period (~30 keys/s), 0 = single hold event
+
+// Interrupt moderation
+#define IRQ_COALESCE_MS 10          // Minimum time between interrupt assertions (0 = off)
+#define IRQ_MOUSE_COALESCE_STEPS 2  // Mouse steps summed per assertion when only the mouse moves
+#define IRQ_WATERMARK 8             // Queued events that fire the interrupt early
+#define IRQ_IMMEDIATE_MASK 0xC1     // Flags that always fire at once (FIFO overflow/watermark, power button)
+#define FIFO_WATERMARK 48           // Queued events that raise I2C_INT_FIFO_WATERMARK (0 = off)
 
 #endif  // CONFIG_H
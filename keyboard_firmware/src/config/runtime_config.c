@@ -0,0 +1,89 @@
+#include "runtime_config.h"
+
+#include <string.h>
+
+#include "config.h"
+#include "../hardware/flash_store.h"
+#include "../input/event_bus.h"
+
+void runtime_config_defaults(runtime_config_t *config) {
+    memset(config, 0, sizeof(runtime_config_t));
+    config->version = RUNTIME_CONFIG_VERSION;
+    config->debounce_ms = DEBOUNCE_MS;
+    config->mouse_update_interval_ms = MOUSE_UPDATE_INTERVAL_MS;
+    config->double_press_window_ms = MODIFIER_DOUBLE_PRESS_WINDOW_MS;
+    config->typematic_delay_ms = TYPEMATIC_DELAY_MS;
+    config->typematic_interval_ms = TYPEMATIC_INTERVAL_MS;
+    config->color_idle = CONFIG_COLOR_IDLE;
+    config->color_power = CONFIG_COLOR_POWER;
+    config->color_pulse = CONFIG_COLOR_PULSE;
+    config->color_mod_fn = CONFIG_COLOR_MOD_FN;
+    config->color_mod_alt = CONFIG_COLOR_MOD_ALT;
+    config->color_mod_shift = CONFIG_COLOR_MOD_SHIFT;
+    config->irq_coalesce_ms = IRQ_COALESCE_MS;
+    config->irq_watermark = IRQ_WATERMARK;
+    config->irq_immediate_mask = IRQ_IMMEDIATE_MASK;
+    config->fifo_watermark = FIFO_WATERMARK;
+    config->shutdown_grace_ms = SHUTDOWN_GRACE_MS;
+    config->idle_sleep_ms = IDLE_SLEEP_MS;
+}
+
+bool runtime_config_validate(const runtime_config_t *config) {
+    if (config->version != RUNTIME_CONFIG_VERSION) {
+        return false;
+    }
+    if (config->debounce_ms < 1 || config->debounce_ms > 100) {
+        return false;
+    }
+    if (config->mouse_update_interval_ms < 1) {
+        return false;
+    }
+    if (config->double_press_window_ms < 50 || config->double_press_window_ms > 2000) {
+        return false;
+    }
+    if (config->typematic_delay_ms < 100 || config->typematic_delay_ms > 2000) {
+        return false;
+    }
+    if (config->typematic_interval_ms != 0 &&
+        (config->typematic_interval_ms < 10 || config->typematic_interval_ms > 1000)) {
+        return false;
+    }
+
+    if (config->irq_watermark < 1 || config->irq_watermark > EVENT_BUS_SIZE) {
+        return false;
+    }
+    if (config->fifo_watermark > EVENT_BUS_SIZE) {
+        return false;
+    }
+    if (config->shutdown_grace_ms > 60000) {
+        return false;
+    }
+    if (config->idle_sleep_ms != 0 && config->idle_sleep_ms < 1000) {
+        return false;
+    }
+
+    const uint32_t colors[] = {
+        config->color_idle, config->color_power, config->color_pulse,
+        config->color_mod_fn, config->color_mod_alt, config->color_mod_shift
+    };
+    for (unsigned i = 0; i < sizeof(colors) / sizeof(colors[0]); i++) {
+        if (colors[i] > 0xFFFFFF) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool runtime_config_load(runtime_config_t *config) {
+    if (flash_store_load(config, sizeof(runtime_config_t)) && runtime_config_validate(config)) {
+        return true;
+    }
+
+    runtime_config_defaults(config);
+    return false;
+}
+
+bool runtime_config_save(const runtime_config_t *config) {
+    return flash_store_save(config, sizeof(runtime_config_t));
+}
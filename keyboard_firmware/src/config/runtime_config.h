@@ -0,0 +1,74 @@
+#ifndef RUNTIME_CONFIG_H
+#define RUNTIME_CONFIG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Layout version; bump when fields move so stale flash records are ignored
+#define RUNTIME_CONFIG_VERSION 5
+
+// Size of the I2C configuration register page
+#define RUNTIME_CONFIG_PAGE_SIZE 0x30
+
+// Host-tunable parameters, defaults from config.h.
+// This is also the byte image of the I2C configuration page (little-endian),
+// so field offsets are part of the register map.
+typedef struct __attribute__((packed)) {
+    uint8_t version;                   // 0x00: RUNTIME_CONFIG_VERSION (read-only)
+    uint8_t debounce_ms;               // 0x01: Key debounce time
+    uint8_t mouse_update_interval_ms;  // 0x02: Digital mouse step interval
+    uint8_t reserved0;                 // 0x03
+    uint16_t double_press_window_ms;   // 0x04: Modifier lock double-press window
+    uint16_t typematic_delay_ms;       // 0x06: Hold time before first repeat
+    uint16_t typematic_interval_ms;    // 0x08: Repeat period (0 = single hold event)
+    uint16_t reserved1;                // 0x0A
+    uint32_t color_idle;               // 0x0C: LED colors as 0x00RRGGBB
+    uint32_t color_power;              // 0x10
+    uint32_t color_pulse;              // 0x14
+    uint32_t color_mod_fn;             // 0x18
+    uint32_t color_mod_alt;            // 0x1C
+    uint32_t color_mod_shift;          // 0x20
+    uint8_t irq_coalesce_ms;           // 0x24: Minimum time between interrupt assertions
+    uint8_t irq_watermark;             // 0x25: Queued events that bypass coalescing
+    uint8_t irq_immediate_mask;        // 0x26: Interrupt flags that bypass coalescing
+    uint8_t fifo_watermark;            // 0x27: Queued events that raise the watermark flag (0 = off)
+    uint16_t shutdown_grace_ms;        // 0x28: Shutdown request to latch release (0 = release at once)
+    uint16_t idle_sleep_ms;            // 0x2A: Inactivity before low-power mode (0 = host request only)
+} runtime_config_t;
+
+_Static_assert(sizeof(runtime_config_t) <= RUNTIME_CONFIG_PAGE_SIZE,
+               "runtime config must fit in the I2C config page");
+
+/**
+ * Fill a configuration with the compile-time defaults from config.h.
+ *
+ * @param config Output configuration
+ */
+void runtime_config_defaults(runtime_config_t *config);
+
+/**
+ * Check that every field is within its supported range.
+ *
+ * @param config Configuration to check
+ * @return true if the configuration can be applied
+ */
+bool runtime_config_validate(const runtime_config_t *config);
+
+/**
+ * Load the persisted configuration, falling back to defaults when flash
+ * holds no valid record for the current layout version.
+ *
+ * @param config Output configuration
+ * @return true if the configuration came from flash
+ */
+bool runtime_config_load(runtime_config_t *config);
+
+/**
+ * Persist a configuration to flash.
+ *
+ * @param config Configuration to store (must be valid)
+ * @return true on success
+ */
+bool runtime_config_save(const runtime_config_t *config);
+
+#endif  // RUNTIME_CONFIG_H
@@ -0,0 +1,20 @@
+#ifndef TUSB_CONFIG_H
+#define TUSB_CONFIG_H
+
+// TinyUSB configuration for the USB HID transport (CONFIG_TRANSPORT_USB_HID)
+
+#define CFG_TUSB_RHPORT0_MODE (OPT_MODE_DEVICE | OPT_MODE_FULL_SPEED)
+#define CFG_TUSB_OS OPT_OS_PICO
+
+#define CFG_TUD_ENDPOINT0_SIZE 64
+
+// Two HID interfaces: boot keyboard and relative mouse
+#define CFG_TUD_HID 2
+#define CFG_TUD_CDC 0
+#define CFG_TUD_MSC 0
+#define CFG_TUD_MIDI 0
+#define CFG_TUD_VENDOR 0
+
+#define CFG_TUD_HID_EP_BUFSIZE 16
+
+#endif  // TUSB_CONFIG_H
@@ -5,6 +5,7 @@
 
 static repeating_timer_t tick_timer;
 static volatile bool tick_flag = false;
+static uint32_t tick_interval_us = 1000;
 
 static bool tick_callback(repeating_timer_t *rt) {
     (void)rt;
@@ -14,9 +15,21 @@ static bool tick_callback(repeating_timer_t *rt) {
 
 void tick_service_init(uint32_t interval_us) {
     tick_flag = false;
+    tick_interval_us = interval_us;
     add_repeating_timer_us(-((int64_t)interval_us), tick_callback, NULL, &tick_timer);
 }
 
+void tick_service_suspend(void) {
+    cancel_repeating_timer(&tick_timer);
+    tick_flag = false;
+}
+
+void tick_service_resume(void) {
+    // The first tick is due at once, not one interval after the wake
+    tick_flag = true;
+    add_repeating_timer_us(-((int64_t)tick_interval_us), tick_callback, NULL, &tick_timer);
+}
+
 bool tick_consume(void) {
     if (tick_flag) {
         tick_flag = false;
@@ -5,6 +5,8 @@
 #include <stdint.h>
 
 void tick_service_init(uint32_t interval_us);
+void tick_service_suspend(void);  // Stop the periodic interrupt (low-power mode)
+void tick_service_resume(void);   // Restart it; the next tick_consume() succeeds at once
 bool tick_consume(void);
 uint32_t tick_now_ms(void);
 
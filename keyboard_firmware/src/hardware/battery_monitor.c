@@ -0,0 +1,161 @@
+#include "battery_monitor.h"
+
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "../config/config.h"
+
+// ADC clock and reference
+#define ADC_CLOCK_HZ 48000000u
+#define ADC_VREF_MV 3300u
+#define ADC_FIRST_GPIO 26
+
+// Samples are written by DMA; the write address wraps on the ring size, so
+// the buffer is aligned to its size in bytes
+static uint16_t ring[BATTERY_RING_SIZE] __attribute__((aligned(BATTERY_RING_SIZE * sizeof(uint16_t))));
+static int dma_channel = -1;
+
+// Filtered reading in ADC counts with 8 fraction bits (12.8 fixed point).
+// Summing the 256-sample ring yields exactly this format.
+static uint32_t filtered_q8 = 0;
+static bool filter_primed = false;
+static uint32_t last_update_ms = 0;
+
+static uint16_t voltage_mv = 0;
+static uint8_t percent = 0;
+
+// Resting voltage to state of charge for a 1S Li-ion cell, descending
+typedef struct {
+    uint16_t mv;
+    uint8_t percent;
+} soc_point_t;
+
+static const soc_point_t soc_curve[] = {
+    {4200, 100}, {4100, 90}, {4000, 78}, {3900, 65}, {3800, 50}, {3750, 40},
+    {3700, 30}, {3650, 20}, {3600, 12}, {3500, 5}, {3300, 0},
+};
+
+#define SOC_POINTS (sizeof(soc_curve) / sizeof(soc_curve[0]))
+
+static uint8_t voltage_to_percent(uint16_t mv) {
+    if (mv >= soc_curve[0].mv) {
+        return soc_curve[0].percent;
+    }
+    for (unsigned i = 1; i < SOC_POINTS; i++) {
+        const soc_point_t *hi = &soc_curve[i - 1];
+        const soc_point_t *lo = &soc_curve[i];
+        if (mv >= lo->mv) {
+            // Linear interpolation within the segment
+            return (uint8_t)(lo->percent + (uint32_t)(mv - lo->mv) * (hi->percent - lo->percent) /
+                                               (hi->mv - lo->mv));
+        }
+    }
+    return 0;
+}
+
+// Start (or restart) the DMA stream; the ring wrap keeps it in bounds
+static void start_stream(void) {
+    dma_channel_set_write_addr((uint)dma_channel, ring, false);
+    dma_channel_set_trans_count((uint)dma_channel, UINT32_MAX, true);
+}
+
+void battery_monitor_init(uint32_t gpio) {
+    adc_init();
+    adc_gpio_init(gpio);
+    adc_select_input(gpio - ADC_FIRST_GPIO);
+
+    // Every conversion goes to the FIFO and raises the DMA request
+    adc_fifo_setup(true, true, 1, false, false);
+    adc_set_clkdiv((float)(ADC_CLOCK_HZ / BATTERY_SAMPLE_RATE_HZ - 1));
+
+    if (dma_channel < 0) {
+        dma_channel = dma_claim_unused_channel(true);
+    }
+    dma_channel_config config = dma_channel_get_default_config((uint)dma_channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+    channel_config_set_read_increment(&config, false);
+    channel_config_set_write_increment(&config, true);
+    channel_config_set_ring(&config, true, BATTERY_RING_BITS + 1);  // Ring size in bytes, log2
+    channel_config_set_dreq(&config, DREQ_ADC);
+    dma_channel_configure((uint)dma_channel, &config, ring, &adc_hw->fifo, 0, false);
+
+    filtered_q8 = 0;
+    filter_primed = false;
+    last_update_ms = 0;
+    voltage_mv = 0;
+    percent = 0;
+
+    start_stream();
+    adc_run(true);
+}
+
+bool battery_monitor_tick(uint32_t now_ms) {
+    if (dma_channel < 0 || now_ms - last_update_ms < BATTERY_UPDATE_INTERVAL_MS) {
+        return false;
+    }
+    last_update_ms = now_ms;
+
+    uint32_t remaining = dma_channel_hw_addr((uint)dma_channel)->transfer_count;
+
+    // The stream ends after 2^32 samples (weeks); start it again
+    if (!dma_channel_is_busy((uint)dma_channel)) {
+        start_stream();
+        return false;
+    }
+
+    // Wait until the ring holds real samples only
+    if (UINT32_MAX - remaining < BATTERY_RING_SIZE) {
+        return false;
+    }
+
+    uint32_t sum = 0;
+    for (unsigned i = 0; i < BATTERY_RING_SIZE; i++) {
+        sum += ring[i] & 0x0FFF;
+    }
+
+    // First-order low-pass, time constant of 8 updates
+    if (!filter_primed) {
+        filtered_q8 = sum;
+        filter_primed = true;
+    } else {
+        filtered_q8 = (uint32_t)((int32_t)filtered_q8 + (((int32_t)sum - (int32_t)filtered_q8) / 8));
+    }
+
+    // Counts to millivolts at the battery, through the divider
+    uint64_t mv = (uint64_t)filtered_q8 * ADC_VREF_MV * BATTERY_DIVIDER_RATIO_X100;
+    voltage_mv = (uint16_t)(mv / (4096ull * 256u * 100u));
+    percent = voltage_to_percent(voltage_mv);
+
+    return true;
+}
+
+void battery_monitor_suspend(void) {
+    adc_run(false);
+    while (!(adc_hw->cs & ADC_CS_READY_BITS)) {
+        tight_loop_contents();  // Let the current conversion finish
+    }
+    hw_clear_bits(&adc_hw->cs, ADC_CS_EN_BITS);
+}
+
+void battery_monitor_resume(void) {
+    hw_set_bits(&adc_hw->cs, ADC_CS_EN_BITS);
+    while (!(adc_hw->cs & ADC_CS_READY_BITS)) {
+        tight_loop_contents();
+    }
+    adc_run(true);
+}
+
+uint16_t battery_monitor_get_mv(void) {
+    return voltage_mv;
+}
+
+uint8_t battery_monitor_get_percent(void) {
+    return percent;
+}
+
+uint16_t battery_monitor_get_raw(void) {
+    return (uint16_t)(filtered_q8 >> 8);
+}
+
+bool battery_monitor_is_present(void) {
+    return voltage_mv >= BATTERY_PRESENT_MIN_MV;
+}
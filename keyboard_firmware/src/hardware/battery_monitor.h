@@ -0,0 +1,60 @@
+#ifndef BATTERY_MONITOR_H
+#define BATTERY_MONITOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Battery voltage monitor on one RP2040 ADC input (GP26-GP29).
+// The ADC free-runs at BATTERY_SAMPLE_RATE_HZ and DMA streams every sample
+// into a ring buffer, so sampling costs no CPU time. Each update averages
+// the whole ring (oversampling) and feeds a fixed-point low-pass filter.
+#define BATTERY_RING_BITS 8
+#define BATTERY_RING_SIZE (1u << BATTERY_RING_BITS)  // Samples averaged per update
+
+/**
+ * Start the ADC and the DMA ring.
+ *
+ * @param gpio ADC-capable GPIO (26-29) connected to the battery divider
+ */
+void battery_monitor_init(uint32_t gpio);
+
+/**
+ * Update the filtered reading every BATTERY_UPDATE_INTERVAL_MS.
+ *
+ * @param now_ms Current time in milliseconds
+ * @return true if a new reading is available
+ */
+bool battery_monitor_tick(uint32_t now_ms);
+
+/**
+ * Stop conversions and power the ADC down before its clock stops
+ * (low-power mode). The DMA stream stays armed.
+ */
+void battery_monitor_suspend(void);
+
+/**
+ * Power the ADC up and resume free-running conversions.
+ */
+void battery_monitor_resume(void);
+
+/**
+ * @return Filtered battery voltage in millivolts
+ */
+uint16_t battery_monitor_get_mv(void);
+
+/**
+ * @return State of charge in percent (0-100) from the discharge curve
+ */
+uint8_t battery_monitor_get_percent(void);
+
+/**
+ * @return Filtered ADC reading in counts (12-bit)
+ */
+uint16_t battery_monitor_get_raw(void);
+
+/**
+ * @return true if the voltage is plausible for a connected cell
+ */
+bool battery_monitor_is_present(void);
+
+#endif  // BATTERY_MONITOR_H
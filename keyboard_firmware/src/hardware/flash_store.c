@@ -0,0 +1,136 @@
+#include "flash_store.h"
+
+#include <string.h>
+
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+
+#define FLASH_STORE_MAGIC 0x4B425346u  // "FSBK"
+#define FLASH_STORE_SIZE (FLASH_STORE_SECTOR_COUNT * FLASH_SECTOR_SIZE)
+#define FLASH_STORE_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_STORE_SIZE)
+#define SLOTS_PER_SECTOR ((int)(FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE))
+#define SLOT_COUNT (FLASH_STORE_SECTOR_COUNT * SLOTS_PER_SECTOR)
+
+// Record header stored at the start of each page-sized slot
+typedef struct {
+    uint32_t magic;
+    uint32_t sequence;
+    uint16_t length;
+    uint16_t crc;
+    uint32_t reserved;
+} flash_record_header_t;
+
+_Static_assert(sizeof(flash_record_header_t) + FLASH_STORE_MAX_DATA <= FLASH_PAGE_SIZE,
+               "record must fit in one flash page");
+
+static inline const uint8_t *slot_ptr(int slot) {
+    return (const uint8_t *)(XIP_BASE + FLASH_STORE_OFFSET + (uint32_t)slot * FLASH_PAGE_SIZE);
+}
+
+// CRC-16/CCITT-FALSE
+static uint16_t crc16(const uint8_t *data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static bool slot_is_valid(int slot) {
+    const flash_record_header_t *header = (const flash_record_header_t *)slot_ptr(slot);
+    if (header->magic != FLASH_STORE_MAGIC || header->length > FLASH_STORE_MAX_DATA) {
+        return false;
+    }
+    return crc16(slot_ptr(slot) + sizeof(flash_record_header_t), header->length) == header->crc;
+}
+
+static bool slot_is_blank(int slot) {
+    const uint8_t *p = slot_ptr(slot);
+    for (uint32_t i = 0; i < FLASH_PAGE_SIZE; i++) {
+        if (p[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Find the valid slot with the highest sequence number, or -1
+static int find_newest_slot(void) {
+    int newest = -1;
+    uint32_t newest_seq = 0;
+
+    for (int slot = 0; slot < SLOT_COUNT; slot++) {
+        if (!slot_is_valid(slot)) {
+            continue;
+        }
+        uint32_t seq = ((const flash_record_header_t *)slot_ptr(slot))->sequence;
+        if (newest < 0 || (int32_t)(seq - newest_seq) > 0) {
+            newest = slot;
+            newest_seq = seq;
+        }
+    }
+
+    return newest;
+}
+
+bool flash_store_load(void *data, size_t len) {
+    int slot = find_newest_slot();
+    if (slot < 0) {
+        return false;
+    }
+
+    const flash_record_header_t *header = (const flash_record_header_t *)slot_ptr(slot);
+    if (header->length != len) {
+        return false;  // Layout changed, caller falls back to defaults
+    }
+
+    memcpy(data, slot_ptr(slot) + sizeof(flash_record_header_t), len);
+    return true;
+}
+
+bool flash_store_save(const void *data, size_t len) {
+    if (len > FLASH_STORE_MAX_DATA) {
+        return false;
+    }
+
+    int newest = find_newest_slot();
+    uint32_t sequence = 1;
+    int slot = 0;
+    if (newest >= 0) {
+        sequence = ((const flash_record_header_t *)slot_ptr(newest))->sequence + 1;
+        slot = (newest + 1) % SLOT_COUNT;
+    }
+
+    // Entering a sector (or finding stray data) requires erasing it first.
+    // The newest record always lives in the other sector at that point.
+    bool erase = (slot % SLOTS_PER_SECTOR) == 0 || !slot_is_blank(slot);
+    if (erase && (slot % SLOTS_PER_SECTOR) != 0) {
+        slot = ((slot / SLOTS_PER_SECTOR + 1) % FLASH_STORE_SECTOR_COUNT) * SLOTS_PER_SECTOR;
+    }
+
+    // Build the page image
+    uint8_t page[FLASH_PAGE_SIZE];
+    memset(page, 0xFF, sizeof(page));
+    flash_record_header_t header = {
+        .magic = FLASH_STORE_MAGIC,
+        .sequence = sequence,
+        .length = (uint16_t)len,
+        .crc = crc16((const uint8_t *)data, len),
+        .reserved = 0xFFFFFFFF,
+    };
+    memcpy(page, &header, sizeof(header));
+    memcpy(page + sizeof(header), data, len);
+
+    uint32_t offset = FLASH_STORE_OFFSET + (uint32_t)slot * FLASH_PAGE_SIZE;
+    uint32_t ints = save_and_disable_interrupts();
+    if (erase) {
+        flash_range_erase(offset, FLASH_SECTOR_SIZE);
+    }
+    flash_range_program(offset, page, FLASH_PAGE_SIZE);
+    restore_interrupts(ints);
+
+    return slot_is_valid(slot) && memcmp(slot_ptr(slot), page, sizeof(header) + len) == 0;
+}
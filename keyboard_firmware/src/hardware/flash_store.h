@@ -0,0 +1,35 @@
+#ifndef FLASH_STORE_H
+#define FLASH_STORE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Persistent record store in the last two sectors of flash.
+// Each save appends a CRC-protected record to the next free 256-byte page;
+// sectors are erased alternately only when the writer moves into them, so
+// each sector sees one erase per 16 saves and the newest record in the
+// other sector survives a power loss during the erase.
+#define FLASH_STORE_SECTOR_COUNT 2
+#define FLASH_STORE_MAX_DATA 240  // Page size minus record header
+
+/**
+ * Load the newest valid record.
+ *
+ * @param data Output buffer
+ * @param len Expected record length (must match the stored length)
+ * @return true if a valid record of that length was found
+ */
+bool flash_store_load(void *data, size_t len);
+
+/**
+ * Append a new record. Blocks with interrupts disabled while flash is
+ * erased/programmed (up to ~50 ms when a sector erase is needed).
+ *
+ * @param data Record payload
+ * @param len Payload length (at most FLASH_STORE_MAX_DATA)
+ * @return true if the record was written and verified
+ */
+bool flash_store_save(const void *data, size_t len);
+
+#endif  // FLASH_STORE_H
@@ -1,16 +1,35 @@
 #include "i2c_slave.h"
+#include "hardware/dma.h"
 #include "hardware/i2c.h"
 #include "hardware/irq.h"
 #include "hardware/gpio.h"
+#include "hardware/sync.h"
 #include "pico/stdlib.h"
+#include "../core/crc8.h"
+
+#include <string.h>
+
+// Firmware build hash, generated by the build system
+#ifdef HAVE_FIRMWARE_BUILD_HASH_H
+#include "firmware_build_hash.h"
+#endif
+#ifndef FIRMWARE_BUILD_HASH
+#define FIRMWARE_BUILD_HASH 0x00000000u
+#endif
 
 // Use I2C0 peripheral
 #ifndef I2C_SLAVE_INSTANCE
 #define I2C_SLAVE_INSTANCE i2c0
 #endif
 
+// TX FIFO level at or below which DMA refills it (FIFO is 16 entries deep)
+#define I2C_TX_DMA_THRESHOLD 8
+
+// Largest block staged for DMA (configuration page)
+#define I2C_BLOCK_MAX_SIZE I2C_REG_CONFIG_SIZE
+
 // I2C state
-static key_fifo_t *fifo_ptr = NULL;
+static event_bus_t *event_bus = NULL;
 static uint8_t interrupt_gpio = 0xFF;
 static uint8_t current_register = 0x00;
 
@@ -19,87 +38,417 @@ static volatile uint8_t modifier_mask = 0;
 static volatile int8_t mouse_x_delta = 0;
 static volatile int8_t mouse_y_delta = 0;
 static volatile uint8_t interrupt_status = 0;
+static volatile bool rollover_active = false;
+static volatile uint8_t ghost_count = 0;
+static volatile uint8_t uart_overruns = 0;
+static volatile uint8_t power_status = 0;
+static volatile uint8_t power_command = I2C_POWER_CMD_NONE;
+static volatile uint16_t battery_mv = 0;
+static volatile uint16_t battery_raw = 0;
+static volatile uint8_t battery_percent = 0;
+static volatile uint8_t battery_flags = 0;
+static volatile uint16_t sleep_count = 0;
+static volatile uint8_t wake_source = I2C_WAKE_SOURCE_NONE;
+static volatile uint16_t resume_us = 0;
+static volatile uint16_t first_key_us = 0;
 
-// I2C slave IRQ handler
-static void i2c_slave_irq_handler(void) {
-    uint32_t status = i2c0->hw->intr_stat;
-    
-    // Check if master sent us data (RX_FULL) - register address write
-    if (status & I2C_IC_INTR_STAT_R_RX_FULL_BITS) {
-        // Read the register address
-        current_register = (uint8_t)i2c0->hw->data_cmd;
+// Identification block
+static const uint8_t id_block[I2C_REG_ID_SIZE] = {
+    [I2C_ID_MAGIC0] = I2C_ID_MAGIC0_VALUE,
+    [I2C_ID_MAGIC1] = I2C_ID_MAGIC1_VALUE,
+    [I2C_ID_PROTOCOL_MAJOR] = I2C_PROTOCOL_MAJOR,
+    [I2C_ID_PROTOCOL_MINOR] = I2C_PROTOCOL_MINOR,
+    [I2C_ID_BUILD_HASH + 0] = (uint8_t)(FIRMWARE_BUILD_HASH >> 0),
+    [I2C_ID_BUILD_HASH + 1] = (uint8_t)(FIRMWARE_BUILD_HASH >> 8),
+    [I2C_ID_BUILD_HASH + 2] = (uint8_t)(FIRMWARE_BUILD_HASH >> 16),
+    [I2C_ID_BUILD_HASH + 3] = (uint8_t)(FIRMWARE_BUILD_HASH >> 24),
+    [I2C_ID_CAPABILITIES + 0] = (uint8_t)(I2C_SLAVE_CAPABILITIES & 0xFF),
+    [I2C_ID_CAPABILITIES + 1] = (uint8_t)(I2C_SLAVE_CAPABILITIES >> 8),
+};
+
+// Last event frame, kept until the next frame is built so it can be re-read
+static uint8_t frame[I2C_FRAME_SIZE];
+static uint8_t frame_sequence = 0;
+static uint8_t frame_offset = 0;  // Read position within the current transfer
+static volatile uint32_t frame_clock_ms = 0;  // Last tick time, the reference for event ages
+
+// Block reads: staged as DATA_CMD words and fed to the TX FIFO by DMA, so a
+// whole frame or page costs one RD_REQ interrupt instead of one per byte
+static uint16_t block_buffer[I2C_BLOCK_MAX_SIZE];
+static int tx_dma_channel = -1;
+static bool block_active = false;       // DMA served the current read transaction
+static bool block_sent = false;         // Every staged byte has left the TX FIFO
+static uint8_t block_start_register = 0;
+static uint8_t block_end_register = 0;  // Where per-byte reads continue after the block
+
+// Configuration page - written by the host in IRQ context, consumed by the main loop
+static uint8_t *config_page = NULL;
+static uint8_t config_page_size = 0;
+static volatile uint8_t config_command = I2C_CONFIG_CMD_NONE;
+static volatile uint8_t config_status = I2C_CONFIG_STATUS_IDLE;
+
+// Interrupt moderation
+static uint8_t irq_coalesce_ms = 0;
+static uint16_t irq_mouse_coalesce_ms = 0;
+static uint8_t irq_watermark = 1;
+static uint8_t irq_immediate_mask = 0xFF;
+static volatile bool irq_asserted = false;
+static uint32_t irq_last_assert_ms = 0;
+
+static inline bool is_id_register(uint8_t reg) {
+    return reg >= I2C_REG_ID_BASE && reg < I2C_REG_ID_BASE + I2C_REG_ID_SIZE;
+}
+
+static inline bool is_telemetry_register(uint8_t reg) {
+    return reg >= I2C_REG_TELEMETRY_BASE && reg < I2C_REG_TELEMETRY_BASE + I2C_REG_TELEMETRY_SIZE;
+}
+
+static inline bool is_battery_register(uint8_t reg) {
+    return reg >= I2C_REG_BATTERY_BASE && reg < I2C_REG_BATTERY_BASE + I2C_REG_BATTERY_SIZE;
+}
+
+static inline bool is_sleep_register(uint8_t reg) {
+    return reg >= I2C_REG_SLEEP_BASE && reg < I2C_REG_SLEEP_BASE + I2C_REG_SLEEP_SIZE;
+}
+
+static inline bool is_config_register(uint8_t reg) {
+    return config_page != NULL && reg >= I2C_REG_CONFIG_BASE &&
+           reg < I2C_REG_CONFIG_BASE + config_page_size;
+}
+
+// Pop up to I2C_FRAME_MAX_EVENTS events into a new frame
+static void build_frame(void) {
+    uint32_t now_ms = frame_clock_ms;
+    uint8_t ages[I2C_FRAME_MAX_EVENTS] = { 0 };
+    uint8_t count = 0;
+    while (count < I2C_FRAME_MAX_EVENTS && event_bus != NULL && !event_bus_is_empty(event_bus)) {
+        // Typematic repeats are published with their scheduled time, so the
+        // host can restore the repeat cadence from the ages
+        int32_t age = (int32_t)(now_ms - event_bus_peek(event_bus)->time_ms);
+        ages[count] = (age < 0) ? 0 : (age > 0xFF) ? 0xFF : (uint8_t)age;
+        frame[2 + count] = event_bus_pop(event_bus);
+        count++;
     }
-    
-    // Check if master is reading from us (RD_REQ)
-    if (status & I2C_IC_INTR_STAT_R_RD_REQ_BITS) {
-        uint8_t data = 0;
-        
-        // Serve data based on current register
-        switch (current_register) {
-            case I2C_REG_KEY_STATUS: {
-                // Build status register
-                uint8_t fifo_level = 0;
-                if (fifo_ptr != NULL) {
-                    fifo_level = key_fifo_count(fifo_ptr);
-                    if (fifo_level > 15) {
-                        fifo_level = 15;  // Max 4 bits
-                    }
+    if (count > 0) {
+        frame_sequence++;
+    }
+
+    frame[0] = frame_sequence;
+    frame[1] = count;
+    frame[2 + count] = crc8(frame, 2 + count);
+    for (uint8_t i = 3 + count; i < I2C_FRAME_AGES; i++) {
+        frame[i] = 0;
+    }
+    memcpy(&frame[I2C_FRAME_AGES], ages, sizeof(ages));
+    frame[I2C_FRAME_SIZE - 1] = crc8(frame, I2C_FRAME_SIZE - 1);
+}
+
+static void put_le32(uint8_t *dst, uint32_t value) {
+    dst[0] = (uint8_t)(value >> 0);
+    dst[1] = (uint8_t)(value >> 8);
+    dst[2] = (uint8_t)(value >> 16);
+    dst[3] = (uint8_t)(value >> 24);
+}
+
+// Snapshot the telemetry block; the peak restarts only when it is part of the read
+static void build_telemetry(uint8_t *block, bool take_peak) {
+    memset(block, 0, I2C_REG_TELEMETRY_SIZE);
+    if (event_bus == NULL) {
+        return;
+    }
+
+    block[I2C_TELEMETRY_FIFO_LEVEL] = event_bus_count(event_bus);
+    block[I2C_TELEMETRY_FIFO_PEAK] = take_peak ? event_bus_take_high_water(event_bus)
+                                               : event_bus->high_water;
+    block[I2C_TELEMETRY_FIFO_SIZE] = EVENT_BUS_SIZE;
+    block[I2C_TELEMETRY_UART_OVERRUNS] = uart_overruns;
+    put_le32(&block[I2C_TELEMETRY_DROPS_MATRIX], event_bus->dropped_by_source[EVENT_SOURCE_MATRIX]);
+    put_le32(&block[I2C_TELEMETRY_DROPS_FN], event_bus->dropped_by_source[EVENT_SOURCE_FN]);
+    put_le32(&block[I2C_TELEMETRY_DROPS_EXPANSION],
+             event_bus->dropped_by_source[EVENT_SOURCE_EXPANSION]);
+}
+
+static void build_battery(uint8_t *block) {
+    memset(block, 0, I2C_REG_BATTERY_SIZE);
+    block[I2C_BATTERY_VOLTAGE + 0] = (uint8_t)(battery_mv >> 0);
+    block[I2C_BATTERY_VOLTAGE + 1] = (uint8_t)(battery_mv >> 8);
+    block[I2C_BATTERY_PERCENT] = battery_percent;
+    block[I2C_BATTERY_FLAGS] = battery_flags;
+    block[I2C_BATTERY_RAW + 0] = (uint8_t)(battery_raw >> 0);
+    block[I2C_BATTERY_RAW + 1] = (uint8_t)(battery_raw >> 8);
+}
+
+static void build_sleep(uint8_t *block) {
+    memset(block, 0, I2C_REG_SLEEP_SIZE);
+    block[I2C_SLEEP_COUNT + 0] = (uint8_t)(sleep_count >> 0);
+    block[I2C_SLEEP_COUNT + 1] = (uint8_t)(sleep_count >> 8);
+    block[I2C_SLEEP_WAKE_SOURCE] = wake_source;
+    block[I2C_SLEEP_RESUME_US + 0] = (uint8_t)(resume_us >> 0);
+    block[I2C_SLEEP_RESUME_US + 1] = (uint8_t)(resume_us >> 8);
+    block[I2C_SLEEP_FIRST_KEY_US + 0] = (uint8_t)(first_key_us >> 0);
+    block[I2C_SLEEP_FIRST_KEY_US + 1] = (uint8_t)(first_key_us >> 8);
+}
+
+// Stage the block at current_register and start DMA, returns false for
+// single-byte registers (FIFO, status...) which are served per byte
+static bool start_block_read(void) {
+    uint8_t telemetry[I2C_REG_TELEMETRY_SIZE];
+    uint8_t battery[I2C_REG_BATTERY_SIZE];
+    uint8_t sleep[I2C_REG_SLEEP_SIZE];
+    const uint8_t *src;
+    uint8_t count;
+
+    if (block_active) {
+        return false;  // Block already sent in this transaction
+    }
+
+    if (current_register == I2C_REG_EVENT_FRAME || current_register == I2C_REG_FRAME_REPEAT) {
+        if (current_register == I2C_REG_EVENT_FRAME) {
+            build_frame();
+        }
+        src = frame;
+        count = I2C_FRAME_SIZE;
+        frame_offset = I2C_FRAME_SIZE;  // Bytes past the frame read as 0x00
+    } else if (is_id_register(current_register)) {
+        src = &id_block[current_register - I2C_REG_ID_BASE];
+        count = (uint8_t)(I2C_REG_ID_BASE + I2C_REG_ID_SIZE - current_register);
+    } else if (is_telemetry_register(current_register)) {
+        uint8_t offset = current_register - I2C_REG_TELEMETRY_BASE;
+        build_telemetry(telemetry, offset <= I2C_TELEMETRY_FIFO_PEAK);
+        src = &telemetry[offset];
+        count = (uint8_t)(I2C_REG_TELEMETRY_SIZE - offset);
+    } else if (is_battery_register(current_register)) {
+        uint8_t offset = current_register - I2C_REG_BATTERY_BASE;
+        build_battery(battery);
+        src = &battery[offset];
+        count = (uint8_t)(I2C_REG_BATTERY_SIZE - offset);
+    } else if (is_sleep_register(current_register)) {
+        uint8_t offset = current_register - I2C_REG_SLEEP_BASE;
+        build_sleep(sleep);
+        src = &sleep[offset];
+        count = (uint8_t)(I2C_REG_SLEEP_SIZE - offset);
+    } else if (is_config_register(current_register)) {
+        src = &config_page[current_register - I2C_REG_CONFIG_BASE];
+        count = (uint8_t)(I2C_REG_CONFIG_BASE + config_page_size - current_register);
+    } else {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        block_buffer[i] = src[i];
+    }
+
+    // Reads past the block continue per byte from the following register,
+    // like the byte-wise auto-increment did, but only once it has gone out
+    block_start_register = current_register;
+    block_end_register = current_register;
+    if (current_register != I2C_REG_EVENT_FRAME && current_register != I2C_REG_FRAME_REPEAT) {
+        block_end_register += count;
+    }
+    block_active = true;
+    block_sent = false;
+
+    dma_channel_transfer_from_buffer_now((uint)tx_dma_channel, block_buffer, count);
+    return true;
+}
+
+// End of a read transaction: drop anything DMA has not pushed yet and rewind
+// the register pointer, so every block read starts at the addressed register
+static void finish_block_read(void) {
+    if (!block_active) {
+        return;
+    }
+    dma_channel_abort((uint)tx_dma_channel);
+    current_register = block_start_register;
+    block_active = false;
+    block_sent = false;
+}
+
+uint8_t i2c_slave_read_register(uint8_t reg) {
+    switch (reg) {
+        case I2C_REG_KEY_STATUS: {
+            // Build status register
+            uint8_t fifo_level = 0;
+            if (event_bus != NULL) {
+                fifo_level = event_bus_count(event_bus);
+                if (fifo_level > 15) {
+                    fifo_level = 15;  // Max 4 bits
                 }
-                data = (fifo_level << 4) | (modifier_mask & 0x0F);
-                break;
             }
-            
-            case I2C_REG_FIFO_ACCESS: {
-                // Pop one event from FIFO
-                if (fifo_ptr != NULL) {
-                    data = key_fifo_pop(fifo_ptr);
-                } else {
-                    data = KEY_FIFO_NO_EVENT;
-                }
-                break;
+            uint8_t data = (fifo_level << 4) | (modifier_mask & I2C_KEY_STATUS_MOD_MASK);
+            if (rollover_active) {
+                data |= I2C_KEY_STATUS_ROLLOVER;
             }
-            
-            case I2C_REG_MOUSE_X:
-                data = (uint8_t)mouse_x_delta;
-                break;
-            
-            case I2C_REG_MOUSE_Y:
-                data = (uint8_t)mouse_y_delta;
-                break;
-            
-            case I2C_REG_INTERRUPT:
-                data = interrupt_status;
-                // Reading interrupt register clears it
-                interrupt_status = 0;
-                break;
-            
-            default:
-                data = 0x00;  // Reserved/invalid register
-                break;
+            return data;
         }
         
-        // Send the data
-        i2c0->hw->data_cmd = data;
+        case I2C_REG_FIFO_ACCESS:
+            // Pop one event straight from the event bus
+            return (event_bus != NULL) ? event_bus_pop(event_bus) : EVENT_BUS_NO_EVENT;
         
-        // Clear the RD_REQ interrupt
-        i2c0->hw->clr_rd_req;
+        case I2C_REG_MOUSE_X: {
+            // Movement accumulates until read, so reading hands it over
+            uint8_t data = (uint8_t)mouse_x_delta;
+            mouse_x_delta = 0;
+            return data;
+        }
+        
+        case I2C_REG_MOUSE_Y: {
+            uint8_t data = (uint8_t)mouse_y_delta;
+            mouse_y_delta = 0;
+            return data;
+        }
+        
+        case I2C_REG_GHOST_COUNT:
+            return ghost_count;
+        
+        case I2C_REG_POWER_STATUS: {
+            uint8_t data = power_status;
+            // Reading clears the event bits, the level and latch bits stay
+            power_status &= ~I2C_POWER_STATUS_EVENT_MASK;
+            return data;
+        }
+        
+        case I2C_REG_INTERRUPT: {
+            uint8_t data = interrupt_status;
+            // Reading interrupt register clears it
+            interrupt_status = 0;
+            return data;
+        }
+        
+        case I2C_REG_CONFIG_CTRL:
+            return config_status;
+        
+        default:
+            if (is_id_register(reg)) {
+                return id_block[reg - I2C_REG_ID_BASE];
+            }
+            if (is_telemetry_register(reg)) {
+                uint8_t telemetry[I2C_REG_TELEMETRY_SIZE];
+                uint8_t offset = reg - I2C_REG_TELEMETRY_BASE;
+                build_telemetry(telemetry, offset == I2C_TELEMETRY_FIFO_PEAK);
+                return telemetry[offset];
+            }
+            if (is_battery_register(reg)) {
+                uint8_t battery[I2C_REG_BATTERY_SIZE];
+                build_battery(battery);
+                return battery[reg - I2C_REG_BATTERY_BASE];
+            }
+            if (is_sleep_register(reg)) {
+                uint8_t sleep[I2C_REG_SLEEP_SIZE];
+                build_sleep(sleep);
+                return sleep[reg - I2C_REG_SLEEP_BASE];
+            }
+            if (is_config_register(reg)) {
+                return config_page[reg - I2C_REG_CONFIG_BASE];
+            }
+            return 0x00;  // Reserved/invalid register
     }
+}
+
+void i2c_slave_write_register(uint8_t reg, uint8_t value) {
+    if (is_config_register(reg)) {
+        config_page[reg - I2C_REG_CONFIG_BASE] = value;
+    } else if (reg == I2C_REG_CONFIG_CTRL) {
+        config_command = value;
+        config_status = I2C_CONFIG_STATUS_BUSY;
+    } else if (reg == I2C_REG_POWER_CTRL) {
+        power_command = value;
+    }
+    // Writes to other registers are ignored
+}
+
+// I2C slave IRQ handler
+static void i2c_slave_irq_handler(void) {
+    uint32_t status = i2c0->hw->intr_stat;
     
-    // Clear STOP_DET interrupt if set
+    // A read NACKed before the staged block ran out leaves bytes in the TX
+    // FIFO. The hardware flushes them when the next read command arrives and
+    // raises TX_ABRT together with that RD_REQ; the FIFO stays flushed until
+    // the abort is cleared, so this comes before anything is served.
+    if (status & I2C_IC_INTR_STAT_R_TX_ABRT_BITS) {
+        dma_channel_abort((uint)tx_dma_channel);
+        finish_block_read();
+        i2c0->hw->clr_tx_abrt;
+    }
+
+    // A pending STOP belongs to an earlier transaction: the master waits for
+    // RD_REQ to be served, so handle it before the data of the next one
     if (status & I2C_IC_INTR_STAT_R_STOP_DET_BITS) {
         i2c0->hw->clr_stop_det;
+        finish_block_read();
+        frame_offset = 0;
         
-        // Check if FIFO is now empty and clear interrupt
-        if (fifo_ptr != NULL && key_fifo_is_empty(fifo_ptr)) {
+        // Deassert once the host has drained everything
+        if (interrupt_status == 0 && (event_bus == NULL || event_bus_is_empty(event_bus))) {
             if (interrupt_gpio != 0xFF) {
                 gpio_put(interrupt_gpio, 1);  // Deassert (active low)
             }
+            irq_asserted = false;
         }
     }
+    
+    // Check if master sent us data (RX_FULL)
+    // The first byte of a write is the register address, following bytes
+    // are written to consecutive registers
+    if (status & I2C_IC_INTR_STAT_R_RX_FULL_BITS) {
+        // Bytes arriving meanwhile keep RX_FULL raised and are taken next time
+        for (uint32_t pending = i2c0->hw->rxflr; pending > 0; pending--) {
+            uint32_t data_cmd = i2c0->hw->data_cmd;
+            if (data_cmd & I2C_IC_DATA_CMD_FIRST_DATA_BYTE_BITS) {
+                finish_block_read();
+                current_register = (uint8_t)data_cmd;
+                frame_offset = 0;
+            } else {
+                i2c_slave_write_register(current_register, (uint8_t)data_cmd);
+                current_register++;
+            }
+        }
+    }
+    
+    // Check if master is reading from us (RD_REQ)
+    // Raised only when the TX FIFO is empty: block registers are handed to
+    // DMA on the first request, everything else is served one byte at a time
+    if (status & I2C_IC_INTR_STAT_R_RD_REQ_BITS) {
+        // FIFO empty with nothing left to feed it: the block went out in full
+        if (block_active && !block_sent && !dma_channel_is_busy((uint)tx_dma_channel)) {
+            current_register = block_end_register;
+            block_sent = true;
+        }
+
+        if (!start_block_read() && !dma_channel_is_busy((uint)tx_dma_channel)) {
+            uint8_t data = 0;
+
+            // Serve data based on current register
+            if (current_register == I2C_REG_EVENT_FRAME || current_register == I2C_REG_FRAME_REPEAT) {
+                data = (frame_offset < I2C_FRAME_SIZE) ? frame[frame_offset++] : 0x00;
+            } else {
+                data = i2c_slave_read_register(current_register);
+
+                // Identification, telemetry, battery, low-power and configuration page
+                // reads auto-increment
+                if (is_id_register(current_register) || is_telemetry_register(current_register) ||
+                    is_battery_register(current_register) || is_sleep_register(current_register) ||
+                    is_config_register(current_register)) {
+                    current_register++;
+                }
+            }
+
+            // Send the data
+            i2c0->hw->data_cmd = data;
+        }
+
+        // Clear the RD_REQ interrupt
+        i2c0->hw->clr_rd_req;
+    }
 }
 
 void i2c_slave_init(uint8_t address, uint8_t int_gpio) {
     interrupt_gpio = int_gpio;
+    memset(frame, 0, sizeof(frame));
+    frame_sequence = 0;
+    frame_offset = 0;
+    frame_clock_ms = 0;
     
     // Initialize interrupt GPIO if provided
     if (interrupt_gpio != 0xFF) {
@@ -133,11 +482,30 @@ void i2c_slave_init(uint8_t address, uint8_t int_gpio) {
     // Enable interrupts for slave operations
     i2c0->hw->intr_mask = I2C_IC_INTR_MASK_M_RD_REQ_BITS |
                           I2C_IC_INTR_MASK_M_RX_FULL_BITS |
+                          I2C_IC_INTR_MASK_M_TX_ABRT_BITS |
                           I2C_IC_INTR_MASK_M_STOP_DET_BITS;
+
+    // TX DREQ for block reads
+    i2c0->hw->dma_tdlr = I2C_TX_DMA_THRESHOLD;
+    i2c0->hw->dma_cr |= I2C_IC_DMA_CR_TDMAE_BITS;
     
     // Enable I2C
     i2c0->hw->enable = 1;
     
+    // DMA channel feeding DATA_CMD, paced by the TX DREQ. Transfers are 16-bit
+    // so the byte lands in DATA_CMD[7:0] with the command bits clear.
+    if (tx_dma_channel < 0) {
+        tx_dma_channel = dma_claim_unused_channel(true);
+    }
+    dma_channel_config dma_config = dma_channel_get_default_config((uint)tx_dma_channel);
+    channel_config_set_transfer_data_size(&dma_config, DMA_SIZE_16);
+    channel_config_set_read_increment(&dma_config, true);
+    channel_config_set_write_increment(&dma_config, false);
+    channel_config_set_dreq(&dma_config, i2c_get_dreq(I2C_SLAVE_INSTANCE, true));
+    dma_channel_configure((uint)tx_dma_channel, &dma_config, &i2c0->hw->data_cmd,
+                          block_buffer, 0, false);
+    block_active = false;
+
     // Set up the IRQ handler
     irq_set_exclusive_handler(I2C0_IRQ, i2c_slave_irq_handler);
     irq_set_enabled(I2C0_IRQ, true);
@@ -147,49 +515,193 @@ void i2c_slave_init(uint8_t address, uint8_t int_gpio) {
     mouse_x_delta = 0;
     mouse_y_delta = 0;
     interrupt_status = 0;
+    rollover_active = false;
+    ghost_count = 0;
+    uart_overruns = 0;
+    power_status = 0;
+    power_command = I2C_POWER_CMD_NONE;
+    battery_mv = 0;
+    battery_raw = 0;
+    battery_percent = 0;
+    battery_flags = 0;
+    sleep_count = 0;
+    wake_source = I2C_WAKE_SOURCE_NONE;
+    resume_us = 0;
+    first_key_us = 0;
     current_register = 0x00;
-    fifo_ptr = NULL;
+    event_bus = NULL;
+    config_page = NULL;
+    config_page_size = 0;
+    config_command = I2C_CONFIG_CMD_NONE;
+    config_status = I2C_CONFIG_STATUS_IDLE;
+    irq_asserted = false;
+    irq_last_assert_ms = 0;
+}
+
+void i2c_slave_set_event_bus(event_bus_t *bus) {
+    event_bus = bus;
+}
+
+void i2c_slave_set_config_page(uint8_t *page, uint8_t size) {
+    config_page_size = size > I2C_REG_CONFIG_SIZE ? I2C_REG_CONFIG_SIZE : size;
+    config_page = page;
+}
+
+uint8_t i2c_slave_take_config_command(void) {
+    uint8_t command = config_command;
+    config_command = I2C_CONFIG_CMD_NONE;
+    return command;
 }
 
-void i2c_slave_set_fifo(key_fifo_t *fifo) {
-    fifo_ptr = fifo;
+void i2c_slave_set_config_status(uint8_t status) {
+    config_status = status;
 }
 
 void i2c_slave_update_modifiers(uint8_t mod_mask) {
-    modifier_mask = mod_mask & 0x0F;  // Only 4 bits
+    modifier_mask = mod_mask & I2C_KEY_STATUS_MOD_MASK;  // Bit 3 is the rollover flag
 }
 
-void i2c_slave_update_mouse(int8_t x_delta, int8_t y_delta) {
-    mouse_x_delta = x_delta;
-    mouse_y_delta = y_delta;
+void i2c_slave_update_rollover(bool ghosting, uint32_t count) {
+    rollover_active = ghosting;
+    ghost_count = (uint8_t)count;
+}
+
+void i2c_slave_update_uart_overruns(uint32_t count) {
+    uart_overruns = (count > 0xFF) ? 0xFF : (uint8_t)count;
+}
+
+// power_status is read-modify-written here and in the register read, which
+// clears the events: keep the I2C interrupt out so a consumed event is not
+// written back and reported twice
+void i2c_slave_update_power(bool pressed, bool latch_closed, bool shutdown_pending) {
+    uint32_t irq_state = save_and_disable_interrupts();
+    uint8_t status = power_status & I2C_POWER_STATUS_EVENT_MASK;
+    if (pressed) {
+        status |= I2C_POWER_STATUS_BUTTON;
+        if (!(power_status & I2C_POWER_STATUS_BUTTON)) {
+            status |= I2C_POWER_STATUS_PRESSED;
+        }
+    }
+    if (latch_closed) {
+        status |= I2C_POWER_STATUS_LATCH;
+    }
+    if (shutdown_pending) {
+        status |= I2C_POWER_STATUS_SHUTDOWN;
+    }
+    power_status = status;
+    restore_interrupts(irq_state);
+}
+
+uint8_t i2c_slave_take_power_command(void) {
+    uint8_t command = power_command;
+    power_command = I2C_POWER_CMD_NONE;
+    return command;
+}
+
+void i2c_slave_report_power_events(uint8_t events) {
+    uint32_t irq_state = save_and_disable_interrupts();
+    power_status |= events & I2C_POWER_STATUS_EVENT_MASK;
+    restore_interrupts(irq_state);
+}
+
+void i2c_slave_update_battery(uint16_t voltage_mv, uint8_t percent, uint8_t flags, uint16_t raw) {
+    battery_mv = voltage_mv;
+    battery_percent = percent;
+    battery_flags = flags;
+    battery_raw = raw;
+}
+
+void i2c_slave_update_sleep(bool asleep, uint16_t count, uint8_t source, uint16_t resume,
+                            uint16_t first_key) {
+    sleep_count = count;
+    wake_source = source;
+    resume_us = resume;
+    first_key_us = first_key;
+    if (asleep) {
+        uint32_t irq_state = save_and_disable_interrupts();
+        power_status |= I2C_POWER_STATUS_SLEEP;
+        restore_interrupts(irq_state);
+    }
+}
+
+bool i2c_slave_has_pending_command(void) {
+    return power_command != I2C_POWER_CMD_NONE || config_command != I2C_CONFIG_CMD_NONE;
 }
 
-void i2c_slave_notify_events_available(void) {
-    if (interrupt_gpio != 0xFF && fifo_ptr != NULL && !key_fifo_is_empty(fifo_ptr)) {
-        gpio_put(interrupt_gpio, 0);  // Assert (active low)
+static int8_t add_saturated(int8_t a, int8_t b) {
+    int16_t sum = (int16_t)a + b;
+    if (sum > INT8_MAX) {
+        return INT8_MAX;
+    }
+    if (sum < INT8_MIN) {
+        return INT8_MIN;
     }
+    return (int8_t)sum;
 }
 
-void i2c_slave_check_and_clear_interrupt(void) {
-    if (interrupt_gpio != 0xFF && fifo_ptr != NULL && key_fifo_is_empty(fifo_ptr)) {
-        gpio_put(interrupt_gpio, 1);  // Deassert (active low)
+void i2c_slave_update_mouse(int8_t x_delta, int8_t y_delta) {
+    if (x_delta == 0 && y_delta == 0) {
+        return;
+    }
+
+    // Reading a mouse register clears it, so keep the IRQ out of the update
+    uint32_t irq_state = save_and_disable_interrupts();
+    mouse_x_delta = add_saturated(mouse_x_delta, x_delta);
+    mouse_y_delta = add_saturated(mouse_y_delta, y_delta);
+    restore_interrupts(irq_state);
+}
+
+void i2c_slave_set_interrupt_moderation(uint8_t coalesce_ms, uint16_t mouse_coalesce_ms,
+                                        uint8_t watermark, uint8_t immediate_mask) {
+    irq_coalesce_ms = coalesce_ms;
+    irq_mouse_coalesce_ms = mouse_coalesce_ms > coalesce_ms ? mouse_coalesce_ms : coalesce_ms;
+    irq_watermark = watermark > 0 ? watermark : 1;
+    irq_immediate_mask = immediate_mask;
+}
+
+void i2c_slave_service_interrupt(uint32_t now_ms) {
+    frame_clock_ms = now_ms;
+
+    uint8_t flags = interrupt_status;
+    uint8_t queued = (event_bus != NULL) ? event_bus_count(event_bus) : 0;
+
+    // Nothing left for the host: release the line
+    if (flags == 0 && queued == 0) {
+        if (irq_asserted && interrupt_gpio != 0xFF) {
+            gpio_put(interrupt_gpio, 1);  // Deassert (active low)
+        }
+        irq_asserted = false;
+        return;
+    }
+
+    if (irq_asserted) {
+        return;  // Host has not serviced the previous assertion yet
+    }
+
+    // The first event after a quiet period fires at once; further events
+    // within the coalescing window are batched into the next assertion.
+    // Mouse movement alone waits out its own, longer window: the deltas
+    // add up until read, so the host gets several steps per wakeup.
+    uint16_t window = (flags == I2C_INT_MOUSE_EVENT && queued == 0) ? irq_mouse_coalesce_ms
+                                                                     : irq_coalesce_ms;
+    bool fire = (now_ms - irq_last_assert_ms) >= window ||
+                (flags & irq_immediate_mask) != 0 ||
+                queued >= irq_watermark;
+    if (fire) {
+        if (interrupt_gpio != 0xFF) {
+            gpio_put(interrupt_gpio, 0);  // Assert (active low)
+        }
+        irq_asserted = true;
+        irq_last_assert_ms = now_ms;
     }
 }
 
 void i2c_slave_set_interrupt_flags(uint8_t flags) {
     interrupt_status |= flags;
-    // Assert interrupt line if any flags are set
-    if (interrupt_gpio != 0xFF && interrupt_status != 0) {
-        gpio_put(interrupt_gpio, 0);  // Assert (active low)
-    }
 }
 
 void i2c_slave_clear_interrupt_flags(uint8_t flags) {
     interrupt_status &= ~flags;
-    // Deassert interrupt line if no flags are set
-    if (interrupt_gpio != 0xFF && interrupt_status == 0) {
-        gpio_put(interrupt_gpio, 1);  // Deassert (active low)
-    }
 }
 
 uint8_t i2c_slave_get_interrupt_flags(void) {
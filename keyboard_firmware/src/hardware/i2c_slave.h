@@ -3,7 +3,8 @@
 
 #include <stdbool.h>
 #include <stdint.h>
-#include "key_fifo.h"
+#include "config.h"
+#include "event_bus.h"
 
 // I2C slave configuration
 #define I2C_SLAVE_SDA_GPIO 0
@@ -12,11 +13,148 @@
 #define I2C_SLAVE_BAUDRATE 100000  // 100 kHz
 
 // Register addresses
-#define I2C_REG_KEY_STATUS    0x00  // Key status: bits[3:0]=modifiers, bits[7:4]=FIFO level
+#define I2C_REG_KEY_STATUS    0x00  // Key status: bits[2:0]=modifiers, bit 3=rollover, bits[7:4]=FIFO level
 #define I2C_REG_FIFO_ACCESS   0x01  // FIFO access: pop one event
 #define I2C_REG_MOUSE_X       0x02  // Mouse X position/delta
 #define I2C_REG_MOUSE_Y       0x03  // Mouse Y position/delta
 #define I2C_REG_INTERRUPT     0x04  // Interrupt status: bit flags for interrupt sources
+#define I2C_REG_GHOST_COUNT   0x05  // Ghost pattern episodes since boot (wraps at 255)
+#define I2C_REG_EVENT_FRAME   0x06  // Framed events: pops up to I2C_FRAME_MAX_EVENTS into a new frame
+#define I2C_REG_FRAME_REPEAT  0x07  // Re-read the last frame without popping
+#define I2C_REG_POWER_STATUS  0x08  // Power button level, press events (read-clears) and latch state
+#define I2C_REG_POWER_CTRL    0x09  // Power control: write I2C_POWER_CMD_OFF to release the latch
+#define I2C_REG_ID_BASE       0x10  // Identification block (read-only, auto-increment)
+#define I2C_REG_ID_SIZE       0x10  // Identification block length (0x10-0x1F)
+#define I2C_REG_TELEMETRY_BASE 0x20 // FIFO telemetry block (read-only, auto-increment)
+#define I2C_REG_TELEMETRY_SIZE 0x10 // Telemetry block length (0x20-0x2F)
+#define I2C_REG_BATTERY_BASE  0x30  // Battery block (read-only, auto-increment)
+#define I2C_REG_BATTERY_SIZE  0x08  // Battery block length (0x30-0x37)
+#define I2C_REG_SLEEP_BASE    0x38  // Low-power statistics block (read-only, auto-increment)
+#define I2C_REG_SLEEP_SIZE    0x08  // Low-power statistics block length (0x38-0x3F)
+#define I2C_REG_CONFIG_BASE   0x40  // Runtime configuration page (read/write, auto-increment)
+#define I2C_REG_CONFIG_SIZE   0x30  // Configuration page length (0x40-0x6F)
+#define I2C_REG_CONFIG_CTRL   0x70  // Configuration control: write=command, read=status
+
+// Identification block layout (offsets from I2C_REG_ID_BASE)
+#define I2C_ID_MAGIC0           0x00  // 'L'
+#define I2C_ID_MAGIC1           0x01  // 'K'
+#define I2C_ID_PROTOCOL_MAJOR   0x02  // Incompatible register map changes
+#define I2C_ID_PROTOCOL_MINOR   0x03  // Backwards compatible additions
+#define I2C_ID_BUILD_HASH       0x04  // 4 bytes, little-endian firmware build hash
+#define I2C_ID_CAPABILITIES     0x08  // 2 bytes, little-endian I2C_CAP_* bitmap
+
+#define I2C_ID_MAGIC0_VALUE     0x4C
+#define I2C_ID_MAGIC1_VALUE     0x4B
+#define I2C_PROTOCOL_MAJOR      1
+#define I2C_PROTOCOL_MINOR      7
+
+// Capability bits
+#define I2C_CAP_BURST_READ      (1 << 0)  // Multi-byte reads: FIFO pops per byte, pages auto-increment
+#define I2C_CAP_WIDE_EVENTS     (1 << 1)  // Multi-byte event records
+#define I2C_CAP_TIMESTAMPS      (1 << 2)  // Event frames carry per-event ages
+#define I2C_CAP_IRQ_MODERATION  (1 << 3)  // Coalesced interrupt line
+#define I2C_CAP_CONFIG_PAGE     (1 << 4)  // Runtime configuration page at I2C_REG_CONFIG_BASE
+#define I2C_CAP_EVENT_FRAMES    (1 << 5)  // Sequence-numbered CRC-8 event frames
+#define I2C_CAP_TELEMETRY       (1 << 6)  // FIFO telemetry block and watermark interrupt
+#define I2C_CAP_POWER_STATUS    (1 << 7)  // Power status register at I2C_REG_POWER_STATUS
+#define I2C_CAP_SHUTDOWN        (1 << 8)  // Shutdown request and I2C_REG_POWER_CTRL handshake
+#define I2C_CAP_BATTERY         (1 << 9)  // Battery block at I2C_REG_BATTERY_BASE
+#define I2C_CAP_LOW_POWER       (1 << 10) // Sleep/wake power commands and I2C_REG_SLEEP_BASE block
+
+// Low-power mode is only built with the I2C slave transport (see config.h)
+#ifdef CONFIG_LOW_POWER
+#define I2C_SLAVE_TRANSPORT_CAPABILITIES I2C_CAP_LOW_POWER
+#else
+#define I2C_SLAVE_TRANSPORT_CAPABILITIES 0
+#endif
+
+// Capabilities implemented by this firmware
+#define I2C_SLAVE_CAPABILITIES  (I2C_CAP_BURST_READ | I2C_CAP_IRQ_MODERATION | \
+                                 I2C_CAP_TIMESTAMPS | I2C_CAP_CONFIG_PAGE | I2C_CAP_EVENT_FRAMES | \
+                                 I2C_CAP_TELEMETRY | I2C_CAP_POWER_STATUS | \
+                                 I2C_CAP_SHUTDOWN | I2C_CAP_BATTERY | \
+                                 I2C_SLAVE_TRANSPORT_CAPABILITIES)
+
+// Telemetry block layout (offsets from I2C_REG_TELEMETRY_BASE)
+// A block read is a consistent snapshot; counters are little-endian.
+#define I2C_TELEMETRY_FIFO_LEVEL     0x00  // Queued events (0-EVENT_BUS_SIZE, not saturated)
+#define I2C_TELEMETRY_FIFO_PEAK      0x01  // Peak level since the previous read of this byte
+#define I2C_TELEMETRY_FIFO_SIZE      0x02  // FIFO depth (EVENT_BUS_SIZE)
+#define I2C_TELEMETRY_UART_OVERRUNS  0x03  // UART transport receive overruns (saturates at 255, 0 on I2C)
+#define I2C_TELEMETRY_DROPS_MATRIX   0x04  // 4 bytes, events dropped from the key matrix since boot
+#define I2C_TELEMETRY_DROPS_FN       0x08  // 4 bytes, events dropped from the FN keys since boot
+#define I2C_TELEMETRY_DROPS_EXPANSION 0x0C // 4 bytes, events dropped from the expansion matrix
+
+// Battery block layout (offsets from I2C_REG_BATTERY_BASE), little-endian
+#define I2C_BATTERY_VOLTAGE     0x00  // 2 bytes, filtered cell voltage in mV
+#define I2C_BATTERY_PERCENT     0x02  // State of charge, 0-100
+#define I2C_BATTERY_FLAGS       0x03  // I2C_BATTERY_FLAG_* bits
+#define I2C_BATTERY_RAW         0x04  // 2 bytes, filtered ADC counts (12-bit)
+
+#define I2C_BATTERY_FLAG_VALID   (1 << 0)  // A reading is available
+#define I2C_BATTERY_FLAG_PRESENT (1 << 1)  // Voltage plausible for a connected cell
+#define I2C_BATTERY_FLAG_LOW     (1 << 2)  // Below the low battery threshold
+
+// Low-power statistics block layout (offsets from I2C_REG_SLEEP_BASE), little-endian
+#define I2C_SLEEP_COUNT         0x00  // 2 bytes, low-power entries since boot (wraps)
+#define I2C_SLEEP_WAKE_SOURCE   0x02  // I2C_WAKE_SOURCE_* of the last wake
+#define I2C_SLEEP_RESUME_US     0x04  // 2 bytes, last wake to full clock speed, in us
+#define I2C_SLEEP_FIRST_KEY_US  0x06  // 2 bytes, last wake to the first scanned key event, in us
+                                      // (0 = none yet, saturates at 0xFFFF)
+
+#define I2C_WAKE_SOURCE_NONE    0x00
+#define I2C_WAKE_SOURCE_KEY     0x01  // Matrix or FN key
+#define I2C_WAKE_SOURCE_POWER   0x02  // Power button
+#define I2C_WAKE_SOURCE_HOST    0x03  // Power or configuration command written by the host
+
+// Event frame layout: [sequence][count][event 0..count-1][crc8][zero padding]
+// The sequence increments for every frame that carries events. The CRC-8
+// (polynomial 0x07, init 0x00) covers sequence, count and events.
+// With I2C_CAP_TIMESTAMPS the base frame is followed by [age 0..7][crc8]:
+// the age of each event in ms when the frame was built (saturates at 255,
+// 0 for empty slots) and a CRC-8 over everything before it. Hosts that read
+// only I2C_FRAME_BASE_SIZE bytes see the unchanged base frame.
+#define I2C_FRAME_MAX_EVENTS    8
+#define I2C_FRAME_BASE_SIZE     (2 + I2C_FRAME_MAX_EVENTS + 1)
+#define I2C_FRAME_AGES          I2C_FRAME_BASE_SIZE  // Offset of the event ages
+#define I2C_FRAME_SIZE          (I2C_FRAME_BASE_SIZE + I2C_FRAME_MAX_EVENTS + 1)
+
+// Key status register bit flags
+#define I2C_KEY_STATUS_MOD_MASK     0x07      // Bits 2:0: active modifiers
+#define I2C_KEY_STATUS_ROLLOVER     (1 << 3)  // Bit 3: ghost keys suppressed (rollover limit hit)
+
+// Power status register bit flags
+// Level and latch bits are live; event bits are set until the register is read,
+// so a press and release between two reads is never lost.
+#define I2C_POWER_STATUS_BUTTON      (1 << 0)  // Bit 0: debounced button level (1 = pressed)
+#define I2C_POWER_STATUS_PRESSED     (1 << 1)  // Bit 1: a press started since the last read
+#define I2C_POWER_STATUS_SHORT_PRESS (1 << 2)  // Bit 2: short press completed since the last read
+#define I2C_POWER_STATUS_LONG_PRESS  (1 << 3)  // Bit 3: long press threshold reached since the last read
+#define I2C_POWER_STATUS_LATCH       (1 << 4)  // Bit 4: power latch closed (system held on)
+#define I2C_POWER_STATUS_SHUTDOWN    (1 << 5)  // Bit 5: shutdown requested, latch opens after the grace time
+#define I2C_POWER_STATUS_SLEEP       (1 << 6)  // Bit 6: low-power mode (reads are served at the sleep clock)
+#define I2C_POWER_STATUS_EVENT_MASK  (I2C_POWER_STATUS_PRESSED | I2C_POWER_STATUS_SHORT_PRESS | \
+                                      I2C_POWER_STATUS_LONG_PRESS)
+
+// Power control commands (written to I2C_REG_POWER_CTRL)
+#define I2C_POWER_CMD_NONE      0x00
+#define I2C_POWER_CMD_OFF       0x01  // Host is ready to lose power: release the latch now
+#define I2C_POWER_CMD_SLEEP     0x02  // Enter low-power mode once the FIFO and interrupt flags are drained
+#define I2C_POWER_CMD_WAKE      0x03  // Leave low-power mode (any power or config command also wakes)
+
+// Configuration control commands (written to I2C_REG_CONFIG_CTRL)
+#define I2C_CONFIG_CMD_NONE     0x00
+#define I2C_CONFIG_CMD_APPLY    0x01  // Validate the page and apply it (RAM only)
+#define I2C_CONFIG_CMD_COMMIT   0x02  // Validate, apply and store the page in flash
+#define I2C_CONFIG_CMD_REVERT   0x03  // Reload the page from the active configuration
+#define I2C_CONFIG_CMD_DEFAULTS 0x04  // Load the compile-time defaults into the page
+
+// Configuration control status (read from I2C_REG_CONFIG_CTRL)
+#define I2C_CONFIG_STATUS_IDLE        0x00
+#define I2C_CONFIG_STATUS_BUSY        0x01  // Command accepted, not yet executed
+#define I2C_CONFIG_STATUS_OK          0x02
+#define I2C_CONFIG_STATUS_ERR_INVALID 0x03  // Page rejected, active configuration unchanged
+#define I2C_CONFIG_STATUS_ERR_FLASH   0x04  // Applied, but the flash write failed
 
 // Interrupt status register bit flags
 #define I2C_INT_FIFO_OVERFLOW   (1 << 0)  // Bit 0: FIFO overflow occurred
@@ -26,7 +164,7 @@
 #define I2C_INT_KEY_EVENT       (1 << 4)  // Bit 4: Keyboard key pressed/released
 #define I2C_INT_MOUSE_EVENT     (1 << 5)  // Bit 5: Mouse movement event
 #define I2C_INT_POWER_BUTTON    (1 << 6)  // Bit 6: Power button event
-// Bit 7 reserved
+#define I2C_INT_FIFO_WATERMARK  (1 << 7)  // Bit 7: FIFO level reached the configured watermark
 
 /**
  * Initialize the I2C slave interface.
@@ -37,21 +175,136 @@
 void i2c_slave_init(uint8_t address, uint8_t interrupt_gpio);
 
 /**
- * Set the key FIFO that the I2C interface will read from.
+ * Set the event bus that the I2C interface will consume from.
+ * 
+ * @param bus Pointer to the event bus
+ */
+void i2c_slave_set_event_bus(event_bus_t *bus);
+
+/**
+ * Read a register as the host would, including read side effects
+ * (FIFO_ACCESS pops an event, INTERRUPT clears the flags). Used by the
+ * I2C IRQ and by alternative transports sharing the register map.
+ * 
+ * @param reg Register address
+ * @return Register value (0x00 for reserved registers)
+ */
+uint8_t i2c_slave_read_register(uint8_t reg);
+
+/**
+ * Write a register as the host would. Only the configuration page, the
+ * configuration control and the power control registers are writable.
+ * 
+ * @param reg Register address
+ * @param value Value to write
+ */
+void i2c_slave_write_register(uint8_t reg, uint8_t value);
+
+/**
+ * Set the staging buffer exposed as the configuration register page.
+ * Host writes land in this buffer; they take effect only when the main
+ * loop executes an APPLY or COMMIT command.
+ * 
+ * @param page Staging buffer (at least size bytes)
+ * @param size Number of bytes exposed (at most I2C_REG_CONFIG_SIZE)
+ */
+void i2c_slave_set_config_page(uint8_t *page, uint8_t size);
+
+/**
+ * Take the configuration command written by the host, if any.
+ * 
+ * @return I2C_CONFIG_CMD_* value, or I2C_CONFIG_CMD_NONE
+ */
+uint8_t i2c_slave_take_config_command(void);
+
+/**
+ * Report the result of a configuration command.
  * 
- * @param fifo Pointer to the key FIFO
+ * @param status I2C_CONFIG_STATUS_* value
  */
-void i2c_slave_set_fifo(key_fifo_t *fifo);
+void i2c_slave_set_config_status(uint8_t status);
 
 /**
  * Update the modifier state that will be reported via I2C.
  * 
- * @param modifier_mask Bitmask of active modifiers (bits [3:0])
+ * @param modifier_mask Bitmask of active modifiers (bits [2:0])
  */
 void i2c_slave_update_modifiers(uint8_t modifier_mask);
 
 /**
- * Update the mouse position that will be reported via I2C.
+ * Update the matrix rollover status that will be reported via I2C.
+ * 
+ * @param ghosting true while ghost keys are being suppressed
+ * @param ghost_count Number of ghost episodes since boot
+ */
+void i2c_slave_update_rollover(bool ghosting, uint32_t ghost_count);
+
+/**
+ * Update the UART transport receive overrun count shown in the telemetry block.
+ * 
+ * @param count Overruns since boot (reported saturated at 255)
+ */
+void i2c_slave_update_uart_overruns(uint32_t count);
+
+/**
+ * Update the power button level and latch state reported via I2C.
+ * A rising edge of the button also sets I2C_POWER_STATUS_PRESSED.
+ * 
+ * @param pressed Debounced power button level
+ * @param latch_closed true while the power latch holds the system on
+ * @param shutdown_pending true while a shutdown request waits for the host
+ */
+void i2c_slave_update_power(bool pressed, bool latch_closed, bool shutdown_pending);
+
+/**
+ * Take the power command written by the host, if any.
+ * 
+ * @return I2C_POWER_CMD_* value, or I2C_POWER_CMD_NONE
+ */
+uint8_t i2c_slave_take_power_command(void);
+
+/**
+ * Record power button events until the host reads the power status register.
+ * 
+ * @param events I2C_POWER_STATUS_SHORT_PRESS and/or I2C_POWER_STATUS_LONG_PRESS
+ */
+void i2c_slave_report_power_events(uint8_t events);
+
+/**
+ * Update the battery block reported via I2C.
+ * 
+ * @param voltage_mv Filtered cell voltage in millivolts
+ * @param percent State of charge (0-100)
+ * @param flags I2C_BATTERY_FLAG_* bits
+ * @param raw Filtered ADC counts
+ */
+void i2c_slave_update_battery(uint16_t voltage_mv, uint8_t percent, uint8_t flags, uint16_t raw);
+
+/**
+ * Update the low-power statistics block, and the power status SLEEP bit
+ * until the next i2c_slave_update_power().
+ * 
+ * @param asleep true right before entering low-power mode
+ * @param sleep_count Low-power entries since boot
+ * @param wake_source I2C_WAKE_SOURCE_* of the last wake
+ * @param resume_us Last wake to full clock speed
+ * @param first_key_us Last wake to the first scanned key event (0 = none)
+ */
+void i2c_slave_update_sleep(bool asleep, uint16_t sleep_count, uint8_t wake_source,
+                            uint16_t resume_us, uint16_t first_key_us);
+
+/**
+ * Check for a power or configuration command not yet taken by the main
+ * loop. Safe to call with interrupts disabled; used to leave low-power mode.
+ * 
+ * @return true if the host wrote a command
+ */
+bool i2c_slave_has_pending_command(void);
+
+/**
+ * Add mouse movement to the deltas reported via I2C.
+ * Movement accumulates (saturating at the int8 range) until the host reads
+ * the mouse registers; reading either register clears it.
  * 
  * @param x_delta X position delta (signed 8-bit)
  * @param y_delta Y position delta (signed 8-bit)
@@ -59,19 +312,31 @@ void i2c_slave_update_modifiers(uint8_t modifier_mask);
 void i2c_slave_update_mouse(int8_t x_delta, int8_t y_delta);
 
 /**
- * Notify that new events are available in the FIFO.
- * This will assert the interrupt line if configured.
+ * Configure interrupt moderation.
+ * 
+ * @param coalesce_ms Minimum time between interrupt assertions (0 = no coalescing)
+ * @param mouse_coalesce_ms Window used instead when only mouse movement is
+ *                          pending (never shorter than coalesce_ms)
+ * @param watermark Queued event count that asserts without waiting
+ * @param immediate_mask Interrupt flags (I2C_INT_*) that assert without waiting
  */
-void i2c_slave_notify_events_available(void);
+void i2c_slave_set_interrupt_moderation(uint8_t coalesce_ms, uint16_t mouse_coalesce_ms,
+                                        uint8_t watermark, uint8_t immediate_mask);
 
 /**
- * Check if the FIFO is empty and clear interrupt if needed.
- * Should be called after events are consumed.
+ * Drive the interrupt line from the pending flags and queued events.
+ * Asserts when work is pending and the coalescing window has passed (or an
+ * immediate flag / the watermark is hit); deasserts when nothing is pending.
+ * Call once per tick after all flags have been updated; now_ms is also the
+ * reference for the event ages in event frames.
+ * 
+ * @param now_ms Current time in milliseconds
  */
-void i2c_slave_check_and_clear_interrupt(void);
+void i2c_slave_service_interrupt(uint32_t now_ms);
 
 /**
  * Set one or more interrupt status bits.
+ * The line is driven by i2c_slave_service_interrupt().
  * 
  * @param flags Bit flags to set (OR combination of I2C_INT_* defines)
  */
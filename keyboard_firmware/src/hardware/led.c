@@ -7,6 +7,8 @@
 #define WS2812_SM 0
 #define WS2812_FREQ 800000
 #define WS2812_IS_RGBW false
+#define WS2812_FRAME_US 30   // 24 bits at 800 kHz
+#define WS2812_LATCH_US 80   // Low time that latches the frame
 
 static PIO led_pio = pio0;
 static uint32_t led_pin = 28;
@@ -26,3 +28,11 @@ void led_init(uint32_t pin) {
 void led_set_rgb(uint8_t r, uint8_t g, uint8_t b) {
     pio_sm_put_blocking(led_pio, WS2812_SM, pack_grb(r, g, b) << 8u);
 }
+
+void led_off(void) {
+    led_set_rgb(0, 0, 0);
+    while (!pio_sm_is_tx_fifo_empty(led_pio, WS2812_SM)) {
+        tight_loop_contents();
+    }
+    busy_wait_us(WS2812_FRAME_US + WS2812_LATCH_US);
+}
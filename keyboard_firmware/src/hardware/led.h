@@ -5,5 +5,6 @@
 
 void led_init(uint32_t pin);
 void led_set_rgb(uint8_t r, uint8_t g, uint8_t b);
+void led_off(void);  // Blocks until the LED has latched, so the PIO clock may stop
 
 #endif  // LED_H
@@ -0,0 +1,146 @@
+#include "low_power.h"
+
+#include <stddef.h>
+
+#include "hardware/clocks.h"
+#include "hardware/gpio.h"
+#include "hardware/pll.h"
+#include "hardware/structs/scb.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+
+// Clocks left running while the core sleeps: memories and bus, GPIO and
+// pads (wake pins, held column outputs), I2C0 and DMA (address match and
+// block reads served from the interrupt), timer and its tick, crystal
+#define SLEEP_EN0_KEEP (CLOCKS_SLEEP_EN0_CLK_SYS_SRAM0_BITS | CLOCKS_SLEEP_EN0_CLK_SYS_SRAM1_BITS | \
+                        CLOCKS_SLEEP_EN0_CLK_SYS_SRAM2_BITS | CLOCKS_SLEEP_EN0_CLK_SYS_SRAM3_BITS | \
+                        CLOCKS_SLEEP_EN0_CLK_SYS_BUSFABRIC_BITS | CLOCKS_SLEEP_EN0_CLK_SYS_CLOCKS_BITS | \
+                        CLOCKS_SLEEP_EN0_CLK_SYS_SIO_BITS | CLOCKS_SLEEP_EN0_CLK_SYS_IO_BITS | \
+                        CLOCKS_SLEEP_EN0_CLK_SYS_PADS_BITS | CLOCKS_SLEEP_EN0_CLK_SYS_I2C0_BITS | \
+                        CLOCKS_SLEEP_EN0_CLK_SYS_DMA_BITS)
+#define SLEEP_EN1_KEEP (CLOCKS_SLEEP_EN1_CLK_SYS_SRAM4_BITS | CLOCKS_SLEEP_EN1_CLK_SYS_SRAM5_BITS | \
+                        CLOCKS_SLEEP_EN1_CLK_SYS_TIMER_BITS | CLOCKS_SLEEP_EN1_CLK_SYS_WATCHDOG_BITS | \
+                        CLOCKS_SLEEP_EN1_CLK_SYS_XOSC_BITS)
+
+// PLL settings read back before power-down, so resume restores whatever
+// the SDK configured at boot
+typedef struct {
+    uint32_t refdiv;
+    uint32_t vco_hz;
+    uint32_t post_div1;
+    uint32_t post_div2;
+} pll_setup_t;
+
+// Set by the GPIO interrupt
+static volatile uint32_t woken_gpios = 0;
+static volatile uint32_t woken_us = 0;
+
+static void pll_save(PLL pll, uint32_t ref_hz, pll_setup_t *setup) {
+    setup->refdiv = pll->cs & PLL_CS_REFDIV_BITS;
+    setup->vco_hz = ref_hz / setup->refdiv * (pll->fbdiv_int & PLL_FBDIV_INT_BITS);
+    setup->post_div1 = (pll->prim & PLL_PRIM_POSTDIV1_BITS) >> PLL_PRIM_POSTDIV1_LSB;
+    setup->post_div2 = (pll->prim & PLL_PRIM_POSTDIV2_BITS) >> PLL_PRIM_POSTDIV2_LSB;
+}
+
+static uint32_t pll_output_hz(const pll_setup_t *setup) {
+    return setup->vco_hz / (setup->post_div1 * setup->post_div2);
+}
+
+// Level interrupts keep firing while the pin is low: disarm on the first one
+static void wake_gpio_callback(uint gpio, uint32_t events) {
+    (void)events;
+    gpio_set_irq_enabled(gpio, GPIO_IRQ_LEVEL_LOW, false);
+    if (woken_gpios == 0) {
+        woken_us = time_us_32();
+    }
+    woken_gpios |= 1u << gpio;
+}
+
+static void arm_wake_gpios(uint32_t mask, bool armed) {
+    for (uint gpio = 0; gpio < NUM_BANK0_GPIOS; gpio++) {
+        if (mask & (1u << gpio)) {
+            gpio_set_irq_enabled_with_callback(gpio, GPIO_IRQ_LEVEL_LOW, armed, wake_gpio_callback);
+        }
+    }
+}
+
+void low_power_init(void) {
+    // No UART/SPI (clk_peri), USB or RTC in the I2C slave build
+    clock_stop(clk_peri);
+    clock_stop(clk_usb);
+    clock_stop(clk_rtc);
+}
+
+bool low_power_wake_pending(uint32_t wake_gpio_mask) {
+    return (~gpio_get_all() & wake_gpio_mask) != 0;
+}
+
+void low_power_sleep(uint32_t wake_gpio_mask, bool (*host_wake)(void), low_power_wake_t *wake) {
+    wake->wake_gpios = ~gpio_get_all() & wake_gpio_mask;
+    wake->wake_us = time_us_32();
+    wake->resume_us = 0;
+    if (wake->wake_gpios != 0) {
+        return;  // A key is held; the level interrupt would fire at once
+    }
+
+    woken_gpios = 0;
+    arm_wake_gpios(wake_gpio_mask, true);
+
+    // Run from the crystal (clk_ref) and power both PLLs down. I2C0 keeps
+    // the SDA hold time programmed for the full clock in cycles; at 12 MHz
+    // that is ~3 us, still inside the 100 kHz data valid time.
+    uint32_t ref_hz = clock_get_hz(clk_ref);
+    uint32_t sys_hz = clock_get_hz(clk_sys);
+    uint32_t adc_hz = clock_get_hz(clk_adc);
+    pll_setup_t sys_pll;
+    pll_setup_t usb_pll;
+    pll_save(pll_sys, ref_hz, &sys_pll);
+    pll_save(pll_usb, ref_hz, &usb_pll);
+
+    clock_configure(clk_sys, CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLK_REF, 0, ref_hz, ref_hz);
+    clock_stop(clk_adc);
+    pll_deinit(pll_sys);
+    pll_deinit(pll_usb);
+
+    // Gate everything else while the core is in WFI
+    clocks_hw->sleep_en0 = SLEEP_EN0_KEEP;
+    clocks_hw->sleep_en1 = SLEEP_EN1_KEEP;
+    scb_hw->scr |= M0PLUS_SCR_SLEEPDEEP_BITS;
+
+    // Interrupts stay masked between the check and the WFI so a wake cannot
+    // slip in between; a pending interrupt still ends the WFI and runs once
+    // they are restored. I2C reads are served here without leaving sleep.
+    while (true) {
+        uint32_t irq_state = save_and_disable_interrupts();
+        if (woken_gpios != 0 || (host_wake != NULL && host_wake())) {
+            if (woken_gpios == 0) {
+                woken_us = time_us_32();
+            }
+            restore_interrupts(irq_state);
+            break;
+        }
+        __wfi();
+        restore_interrupts(irq_state);
+    }
+
+    scb_hw->scr &= ~M0PLUS_SCR_SLEEPDEEP_BITS;
+    clocks_hw->sleep_en0 = 0xFFFFFFFFu;  // Reset value: all clocks on
+    clocks_hw->sleep_en1 = 0xFFFFFFFFu;
+
+    // System clock first: scanning needs nothing else
+    pll_init(pll_sys, sys_pll.refdiv, sys_pll.vco_hz, sys_pll.post_div1, sys_pll.post_div2);
+    clock_configure(clk_sys, CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLKSRC_CLK_SYS_AUX,
+                    CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS, pll_output_hz(&sys_pll), sys_hz);
+    wake->resume_us = time_us_32() - woken_us;
+
+    // Then the ADC clock for the battery monitor
+    pll_init(pll_usb, usb_pll.refdiv, usb_pll.vco_hz, usb_pll.post_div1, usb_pll.post_div2);
+    if (adc_hz != 0) {
+        clock_configure(clk_adc, 0, CLOCKS_CLK_ADC_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB,
+                        pll_output_hz(&usb_pll), adc_hz);
+    }
+
+    arm_wake_gpios(wake_gpio_mask, false);
+    wake->wake_gpios = woken_gpios;
+    wake->wake_us = woken_us;
+}
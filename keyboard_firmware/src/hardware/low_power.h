@@ -0,0 +1,45 @@
+#ifndef LOW_POWER_H
+#define LOW_POWER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Low-power mode for the I2C slave build.
+// The system clock drops to the crystal (12 MHz), both PLLs and the unused
+// clock domains stop, and the core sleeps with only the blocks needed to
+// wake it clocked: GPIO (keys, power button), I2C0 with its TX DMA (address
+// match) and the timer. Dormant mode would also stop the crystal and the
+// I2C block, so the host could no longer reach the keyboard.
+// While asleep the I2C interrupt still serves register reads at 12 MHz.
+
+// How the last sleep ended
+typedef struct {
+    uint32_t wake_gpios;  // Wake pins found active (0 = woken by the host)
+    uint32_t wake_us;     // time_us_32() when the wake was detected
+    uint32_t resume_us;   // Wake to the system clock running at full speed
+} low_power_wake_t;
+
+/**
+ * Stop the clock domains the I2C build never uses (clk_peri, clk_usb, clk_rtc).
+ * Call once, before the first low_power_sleep().
+ */
+void low_power_init(void);
+
+/**
+ * @param wake_gpio_mask Active-low wake pins
+ * @return true if a wake pin is already low (a sleep would end at once)
+ */
+bool low_power_wake_pending(uint32_t wake_gpio_mask);
+
+/**
+ * Sleep until a wake pin goes low or the host asks to resume.
+ * Returns at once, without touching the clocks, if a wake pin is already low.
+ * The caller quiesces timers, DMA streams and the LED beforehand.
+ *
+ * @param wake_gpio_mask Active-low wake pins (inputs with pull-ups)
+ * @param host_wake Polled after every interrupt, true ends the sleep (may be NULL)
+ * @param wake Output: wake source and timing
+ */
+void low_power_sleep(uint32_t wake_gpio_mask, bool (*host_wake)(void), low_power_wake_t *wake);
+
+#endif  // LOW_POWER_H
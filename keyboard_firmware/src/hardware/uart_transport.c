@@ -0,0 +1,244 @@
+#include "uart_transport.h"
+
+#include <stddef.h>
+
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/uart.h"
+#include "i2c_slave.h"
+#include "../core/crc8.h"
+
+#define UART_TRANSPORT_INSTANCE uart0
+#define UART_TRANSPORT_IRQ UART0_IRQ
+
+// Receive ring between the RX interrupt and the tick (power of two)
+#define UART_RX_RING_SIZE 256
+#define UART_RX_RING_MASK (UART_RX_RING_SIZE - 1)
+
+// Receive parser states
+typedef enum {
+    RX_WAIT_SYNC = 0,
+    RX_HEADER,
+    RX_PAYLOAD,
+    RX_CRC
+} rx_state_t;
+
+// Transmit state - the buffer is owned by DMA while a transfer is running
+static uint8_t tx_buffer[UART_PACKET_OVERHEAD + UART_MAX_PAYLOAD];
+static int dma_channel = -1;
+static uint8_t tx_sequence = 0;
+
+// Receive ring - filled by the RX interrupt, drained by uart_transport_tick()
+static uint8_t rx_ring[UART_RX_RING_SIZE];
+static volatile uint16_t rx_ring_head = 0;
+static volatile uint16_t rx_ring_tail = 0;
+static volatile uint32_t rx_overruns = 0;
+static uint32_t rx_overruns_reported = 0;
+
+// Receive state
+static rx_state_t rx_state = RX_WAIT_SYNC;
+static uint8_t rx_buffer[3 + UART_MAX_PAYLOAD];  // type, sequence, length, payload
+static uint8_t rx_pos = 0;
+
+// Replies owed to the host
+static bool identify_pending = false;
+static bool read_reg_pending = false;
+static uint8_t read_reg_address = 0;
+
+static void send_packet(uint8_t type, uint8_t length) {
+    tx_buffer[0] = UART_SYNC_BYTE;
+    tx_buffer[1] = type;
+    tx_buffer[2] = tx_sequence++;
+    tx_buffer[3] = length;
+    tx_buffer[4 + length] = crc8(&tx_buffer[1], 3 + length);
+
+    dma_channel_transfer_from_buffer_now((uint)dma_channel, tx_buffer,
+                                         UART_PACKET_OVERHEAD + length);
+}
+
+static void handle_command(uint8_t type, const uint8_t *payload, uint8_t length) {
+    switch (type) {
+        case UART_CMD_IDENTIFY:
+            identify_pending = true;
+            break;
+
+        case UART_CMD_READ_REG:
+            if (length >= 1) {
+                read_reg_address = payload[0];
+                read_reg_pending = true;
+            }
+            break;
+
+        case UART_CMD_WRITE_REG:
+            for (uint8_t i = 1; i < length; i++) {
+                i2c_slave_write_register((uint8_t)(payload[0] + i - 1), payload[i]);
+            }
+            break;
+
+        default:
+            break;  // Unknown commands are ignored
+    }
+}
+
+// Feed one received byte to the packet parser
+static void receive_byte(uint8_t byte) {
+    switch (rx_state) {
+        case RX_WAIT_SYNC:
+            if (byte == UART_SYNC_BYTE) {
+                rx_pos = 0;
+                rx_state = RX_HEADER;
+            }
+            break;
+
+        case RX_HEADER:
+            rx_buffer[rx_pos++] = byte;
+            if (rx_pos == 3) {
+                if (rx_buffer[2] > UART_MAX_PAYLOAD) {
+                    rx_state = RX_WAIT_SYNC;  // Not a packet, resynchronize
+                } else {
+                    rx_state = (rx_buffer[2] > 0) ? RX_PAYLOAD : RX_CRC;
+                }
+            }
+            break;
+
+        case RX_PAYLOAD:
+            rx_buffer[rx_pos++] = byte;
+            if (rx_pos == 3 + rx_buffer[2]) {
+                rx_state = RX_CRC;
+            }
+            break;
+
+        case RX_CRC:
+            if (crc8(rx_buffer, rx_pos) == byte) {
+                handle_command(rx_buffer[0], &rx_buffer[3], rx_buffer[2]);
+            }
+            rx_state = RX_WAIT_SYNC;
+            break;
+    }
+}
+
+// The 32-byte RX FIFO fills in about 0.2 ms at 1.5 Mbaud, so it is emptied
+// from the RX and receive timeout interrupts rather than once per tick
+static void uart_rx_irq_handler(void) {
+    uart_hw_t *hw = uart_get_hw(UART_TRANSPORT_INSTANCE);
+    bool ring_full = false;
+
+    while (uart_is_readable(UART_TRANSPORT_INSTANCE)) {
+        uint8_t byte = (uint8_t)hw->dr;
+        uint16_t head = rx_ring_head;
+        if ((uint16_t)(head - rx_ring_tail) >= UART_RX_RING_SIZE) {
+            ring_full = true;  // Tick has fallen behind, drop the byte
+            continue;
+        }
+        rx_ring[head & UART_RX_RING_MASK] = byte;
+        rx_ring_head = head + 1;
+    }
+
+    // Bytes lost in hardware: the FIFO was full when a character arrived
+    if (hw->rsr & UART_UARTRSR_OE_BITS) {
+        hw->rsr = UART_UARTRSR_BITS;  // Any write clears the error bits
+        rx_overruns++;
+    }
+    if (ring_full) {
+        rx_overruns++;
+    }
+}
+
+void uart_transport_init(void) {
+    uart_init(UART_TRANSPORT_INSTANCE, UART_TRANSPORT_BAUDRATE);
+    gpio_set_function(UART_TRANSPORT_TX_GPIO, GPIO_FUNC_UART);
+    gpio_set_function(UART_TRANSPORT_RX_GPIO, GPIO_FUNC_UART);
+    uart_set_fifo_enabled(UART_TRANSPORT_INSTANCE, true);
+
+    // DMA feeds the TX FIFO, paced by the UART TX DREQ
+    dma_channel = dma_claim_unused_channel(true);
+    dma_channel_config config = dma_channel_get_default_config((uint)dma_channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, uart_get_dreq(UART_TRANSPORT_INSTANCE, true));
+    dma_channel_configure((uint)dma_channel, &config,
+                          &uart_get_hw(UART_TRANSPORT_INSTANCE)->dr,
+                          tx_buffer, 0, false);
+
+    rx_ring_head = 0;
+    rx_ring_tail = 0;
+    rx_overruns = 0;
+    rx_overruns_reported = 0;
+    rx_state = RX_WAIT_SYNC;
+    tx_sequence = 0;
+    identify_pending = true;  // Announce ourselves after boot
+    read_reg_pending = false;
+
+    // RX and receive timeout interrupts fill the ring; overruns interrupt too
+    irq_set_exclusive_handler(UART_TRANSPORT_IRQ, uart_rx_irq_handler);
+    uart_set_irq_enables(UART_TRANSPORT_INSTANCE, true, false);
+    hw_set_bits(&uart_get_hw(UART_TRANSPORT_INSTANCE)->imsc, UART_UARTIMSC_OEIM_BITS);
+    irq_set_enabled(UART_TRANSPORT_IRQ, true);
+}
+
+uint32_t uart_transport_get_rx_overruns(void) {
+    return rx_overruns;
+}
+
+void uart_transport_tick(void) {
+    // Handle host commands received since the last tick
+    uint16_t head = rx_ring_head;
+    while (rx_ring_tail != head) {
+        receive_byte(rx_ring[rx_ring_tail & UART_RX_RING_MASK]);
+        rx_ring_tail++;
+    }
+
+    uint32_t overruns = rx_overruns;
+    if (overruns != rx_overruns_reported) {
+        rx_overruns_reported = overruns;
+        i2c_slave_update_uart_overruns(overruns);
+    }
+
+    if (dma_channel_is_busy((uint)dma_channel)) {
+        return;  // Previous packet still on the wire
+    }
+
+    uint8_t *payload = &tx_buffer[4];
+
+    if (identify_pending) {
+        identify_pending = false;
+        for (uint8_t i = 0; i < I2C_REG_ID_SIZE; i++) {
+            payload[i] = i2c_slave_read_register(I2C_REG_ID_BASE + i);
+        }
+        send_packet(UART_PKT_ID, I2C_REG_ID_SIZE);
+        return;
+    }
+
+    if (read_reg_pending) {
+        read_reg_pending = false;
+        payload[0] = read_reg_address;
+        payload[1] = i2c_slave_read_register(read_reg_address);
+        send_packet(UART_PKT_REGISTER, 2);
+        return;
+    }
+
+    // Push a report whenever the I2C interrupt line would be asserted
+    uint8_t key_status = i2c_slave_read_register(I2C_REG_KEY_STATUS);
+    if (i2c_slave_get_interrupt_flags() == 0 && (key_status >> 4) == 0) {
+        return;
+    }
+
+    payload[0] = key_status;
+    payload[1] = i2c_slave_read_register(I2C_REG_INTERRUPT);
+    payload[2] = i2c_slave_read_register(I2C_REG_MOUSE_X);
+    payload[3] = i2c_slave_read_register(I2C_REG_MOUSE_Y);
+    payload[4] = i2c_slave_read_register(I2C_REG_GHOST_COUNT);
+
+    uint8_t length = UART_REPORT_HEADER_LEN;
+    while (length < UART_MAX_PAYLOAD) {
+        uint8_t event = i2c_slave_read_register(I2C_REG_FIFO_ACCESS);
+        if (event == EVENT_BUS_NO_EVENT) {
+            break;
+        }
+        payload[length++] = event;
+    }
+
+    send_packet(UART_PKT_REPORT, length);
+}
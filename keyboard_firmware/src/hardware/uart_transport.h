@@ -0,0 +1,60 @@
+#ifndef UART_TRANSPORT_H
+#define UART_TRANSPORT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// UART transport configuration (UART0 on the I2C pins)
+#define UART_TRANSPORT_TX_GPIO 0
+#define UART_TRANSPORT_RX_GPIO 1
+#define UART_TRANSPORT_BAUDRATE 1500000
+
+// Packet framing, both directions:
+// [UART_SYNC_BYTE][type][sequence][length][payload 0..length-1][crc8]
+// The CRC-8 (polynomial 0x07, init 0x00) covers type, sequence, length and payload.
+#define UART_SYNC_BYTE 0xA5
+#define UART_PACKET_OVERHEAD 5
+#define UART_MAX_PAYLOAD 40
+
+// Device to host packet types
+#define UART_PKT_REPORT   0x01  // [KEY_STATUS][INTERRUPT][MOUSE_X][MOUSE_Y][GHOST_COUNT][events...]
+#define UART_PKT_ID       0x02  // Identification block (I2C registers 0x10-0x1F)
+#define UART_PKT_REGISTER 0x03  // [register][value] reply to UART_CMD_READ_REG
+
+// Host to device commands (packet type, payload as listed)
+#define UART_CMD_IDENTIFY  0x81  // no payload, answered with UART_PKT_ID
+#define UART_CMD_READ_REG  0x82  // [register], answered with UART_PKT_REGISTER
+#define UART_CMD_WRITE_REG 0x83  // [register][value...], auto-increments
+
+// Report header length before the event bytes
+#define UART_REPORT_HEADER_LEN 5
+
+/**
+ * Initialize the UART transport.
+ * Configures UART0 on GP0/GP1, claims a DMA channel for transmit and
+ * installs the UART0 interrupt, which moves received bytes into a ring
+ * buffer so the hardware FIFO cannot overrun between ticks.
+ * Events and state are taken from the I2C register map, so the register
+ * update functions in i2c_slave.h are used unchanged.
+ */
+void uart_transport_init(void);
+
+/**
+ * Push pending state to the host and handle host commands.
+ * Commands are parsed from the bytes the RX interrupt has buffered.
+ * Sends a report whenever interrupt flags are set or events are queued;
+ * if the previous packet is still being transmitted the report waits for
+ * the next tick. Call once per tick after all registers have been updated.
+ */
+void uart_transport_tick(void);
+
+/**
+ * Get the number of receive overruns since boot.
+ * Counts UARTRSR.OE (RX FIFO full) and receive ring overflows; also
+ * reported in the telemetry block (I2C_TELEMETRY_UART_OVERRUNS).
+ *
+ * @return Overrun count
+ */
+uint32_t uart_transport_get_rx_overruns(void);
+
+#endif  // UART_TRANSPORT_H
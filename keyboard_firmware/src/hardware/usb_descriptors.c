@@ -0,0 +1,106 @@
+#include <string.h>
+
+#include "tusb.h"
+#include "usb_hid.h"
+
+// USB device identity (pid.codes test VID/PID, replace for production)
+#define USB_VID 0x1209
+#define USB_PID 0x0001
+#define USB_BCD_DEVICE 0x0100
+
+enum {
+    STRID_LANGID = 0,
+    STRID_MANUFACTURER,
+    STRID_PRODUCT,
+};
+
+static const tusb_desc_device_t device_descriptor = {
+    .bLength = sizeof(tusb_desc_device_t),
+    .bDescriptorType = TUSB_DESC_DEVICE,
+    .bcdUSB = 0x0200,
+    .bDeviceClass = 0x00,  // Class defined per interface
+    .bDeviceSubClass = 0x00,
+    .bDeviceProtocol = 0x00,
+    .bMaxPacketSize0 = CFG_TUD_ENDPOINT0_SIZE,
+    .idVendor = USB_VID,
+    .idProduct = USB_PID,
+    .bcdDevice = USB_BCD_DEVICE,
+    .iManufacturer = STRID_MANUFACTURER,
+    .iProduct = STRID_PRODUCT,
+    .iSerialNumber = 0,
+    .bNumConfigurations = 1,
+};
+
+// Separate interfaces (rather than report IDs) keep both usable by
+// boot-protocol hosts such as BIOS setup screens
+static const uint8_t keyboard_report_descriptor[] = {
+    TUD_HID_REPORT_DESC_KEYBOARD()
+};
+
+static const uint8_t mouse_report_descriptor[] = {
+    TUD_HID_REPORT_DESC_MOUSE()
+};
+
+#define EPNUM_KEYBOARD 0x81
+#define EPNUM_MOUSE    0x82
+#define CONFIG_TOTAL_LEN (TUD_CONFIG_DESC_LEN + 2 * TUD_HID_DESC_LEN)
+
+static const uint8_t configuration_descriptor[] = {
+    // Config number, interface count, string index, total length, attributes, power in mA
+    TUD_CONFIG_DESCRIPTOR(1, 2, 0, CONFIG_TOTAL_LEN, TUSB_DESC_CONFIG_ATT_REMOTE_WAKEUP, 100),
+
+    // Interface number, string index, boot protocol, report descriptor length,
+    // EP in address, size, polling interval
+    TUD_HID_DESCRIPTOR(USB_HID_ITF_KEYBOARD, 0, HID_ITF_PROTOCOL_KEYBOARD,
+                       sizeof(keyboard_report_descriptor), EPNUM_KEYBOARD,
+                       CFG_TUD_HID_EP_BUFSIZE, USB_HID_POLL_INTERVAL_MS),
+    TUD_HID_DESCRIPTOR(USB_HID_ITF_MOUSE, 0, HID_ITF_PROTOCOL_MOUSE,
+                       sizeof(mouse_report_descriptor), EPNUM_MOUSE,
+                       CFG_TUD_HID_EP_BUFSIZE, USB_HID_POLL_INTERVAL_MS),
+};
+
+static const char *const string_table[] = {
+    [STRID_MANUFACTURER] = "Luckfox",
+    [STRID_PRODUCT] = "Lyra Keyboard",
+};
+
+const uint8_t *tud_descriptor_device_cb(void) {
+    return (const uint8_t *)&device_descriptor;
+}
+
+const uint8_t *tud_descriptor_configuration_cb(uint8_t index) {
+    (void)index;
+    return configuration_descriptor;
+}
+
+const uint8_t *tud_hid_descriptor_report_cb(uint8_t instance) {
+    return (instance == USB_HID_ITF_MOUSE) ? mouse_report_descriptor : keyboard_report_descriptor;
+}
+
+const uint16_t *tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
+    static uint16_t descriptor[32];
+    (void)langid;
+
+    uint8_t length;
+    if (index == STRID_LANGID) {
+        descriptor[1] = 0x0409;  // English (US)
+        length = 1;
+    } else {
+        if (index >= sizeof(string_table) / sizeof(string_table[0])) {
+            return NULL;
+        }
+        const char *str = string_table[index];
+        length = (uint8_t)strlen(str);
+        if (length > 31) {
+            length = 31;
+        }
+        // ASCII to UTF-16
+        for (uint8_t i = 0; i < length; i++) {
+            descriptor[1 + i] = (uint16_t)str[i];
+        }
+    }
+
+    // First element: descriptor type and total length in bytes
+    descriptor[0] = (uint16_t)((TUSB_DESC_STRING << 8) | (2 * length + 2));
+    return descriptor;
+}
@@ -0,0 +1,298 @@
+#include "usb_hid.h"
+
+#include <stdbool.h>
+
+#include "tusb.h"
+#include "i2c_slave.h"
+#include "../input/event_bus.h"
+#include "../input/modifier_manager.h"
+
+#define KEY_CODE_COUNT 64
+#define KEY_CODE_MOUSE_BUTTON 48  // FN8
+#define HID_KEY_SLOTS 6
+#define HID_USAGE_MODIFIER_FIRST HID_KEY_CONTROL_LEFT  // 0xE0-0xE7 are modifier bits
+
+// Key code to HID usage, mirrors the Lyra driver keymaps.
+// Status-driven modifiers (LSHIFT, ALT, FN) map to 0 and come from KEY_STATUS.
+// RSHIFT is not a firmware modifier and is left unmapped, as in the driver.
+// FN9-FN12 (49-52) drive the digital mouse and never reach the event bus.
+static const uint8_t keymap_normal[KEY_CODE_COUNT] = {
+    HID_KEY_4, HID_KEY_5, HID_KEY_7, HID_KEY_6, HID_KEY_8, HID_KEY_9, HID_KEY_0,            // 0-6
+    HID_KEY_R, HID_KEY_T, HID_KEY_U, HID_KEY_Y, HID_KEY_I, HID_KEY_O, HID_KEY_P,            // 7-13
+    HID_KEY_F, HID_KEY_G, HID_KEY_COMMA, HID_KEY_H, HID_KEY_PERIOD, HID_KEY_L,
+    HID_KEY_ENTER,                                                                          // 14-20
+    HID_KEY_3, HID_KEY_E, HID_KEY_C, HID_KEY_D, 0, HID_KEY_M, HID_KEY_SPACE,                // 21-27
+    HID_KEY_2, HID_KEY_ESCAPE, 0, HID_KEY_TAB, HID_KEY_V, HID_KEY_CONTROL_LEFT,
+    HID_KEY_BACKSPACE,                                                                      // 28-34
+    HID_KEY_1, HID_KEY_Q, 0, HID_KEY_Z, HID_KEY_B, HID_KEY_N, 0,                            // 35-41
+    HID_KEY_W, HID_KEY_A, HID_KEY_S, HID_KEY_X, HID_KEY_J, HID_KEY_K,                       // 42-47 (FN1-FN6)
+    0,                                                                                      // 48 (mouse button)
+};
+
+static const uint8_t keymap_fn[KEY_CODE_COUNT] = {
+    HID_KEY_F4, HID_KEY_F5, HID_KEY_F7, HID_KEY_F6, HID_KEY_F8, HID_KEY_F9, HID_KEY_F10,    // 0-6
+    HID_KEY_MINUS, HID_KEY_MINUS, HID_KEY_EQUAL, HID_KEY_EQUAL, HID_KEY_BACKSLASH,
+    HID_KEY_F11, HID_KEY_F12,                                                               // 7-13
+    HID_KEY_APOSTROPHE, HID_KEY_BRACKET_LEFT, HID_KEY_SLASH, HID_KEY_BRACKET_RIGHT,
+    HID_KEY_END, HID_KEY_HOME, HID_KEY_ENTER,                                               // 14-20
+    HID_KEY_F3, HID_KEY_GRAVE, HID_KEY_SEMICOLON, HID_KEY_SEMICOLON, 0, HID_KEY_SLASH,
+    HID_KEY_SPACE,                                                                          // 21-27
+    HID_KEY_F2, HID_KEY_ESCAPE, 0, HID_KEY_TAB, HID_KEY_APOSTROPHE, HID_KEY_CONTROL_LEFT,
+    HID_KEY_BACKSPACE,                                                                      // 28-34
+    HID_KEY_F1, HID_KEY_GRAVE, 0, HID_KEY_EUROPE_2, HID_KEY_BRACKET_LEFT,
+    HID_KEY_BRACKET_RIGHT, 0,                                                               // 35-41
+    HID_KEY_ARROW_UP, HID_KEY_ARROW_LEFT, HID_KEY_ARROW_RIGHT, HID_KEY_ARROW_DOWN,
+    HID_KEY_A, HID_KEY_B,                                                                   // 42-47
+    0,                                                                                      // 48 (mouse button)
+};
+
+// Usage reported for each held key code, so a release matches its press
+// even if the FN layer changed in between (0 = not held)
+static uint8_t held_usage[KEY_CODE_COUNT];
+
+// Keyboard report state
+static uint8_t held_modifiers = 0;   // Modifier bits from held CTRL keys
+static uint8_t held_keys[HID_KEY_SLOTS];
+static uint8_t sent_modifiers = 0;
+static bool sent_phantom = false;
+
+// Event popped from the register map but not yet reported
+static uint8_t pending_event = EVENT_BUS_NO_EVENT;
+
+// Mouse report state
+static int16_t mouse_accum_x = 0;
+static int16_t mouse_accum_y = 0;
+static uint8_t mouse_buttons = 0;
+static uint8_t mouse_held_button = 0;
+static bool mouse_buttons_dirty = false;
+
+static uint8_t status_modifiers(uint8_t key_status) {
+    uint8_t modifiers = 0;
+    if (key_status & (1 << MODIFIER_SHIFT)) {
+        modifiers |= KEYBOARD_MODIFIER_LEFTSHIFT;
+    }
+    if (key_status & (1 << MODIFIER_ALT)) {
+        modifiers |= KEYBOARD_MODIFIER_LEFTALT;
+    }
+    return modifiers;
+}
+
+static void hold_usage(uint8_t usage) {
+    if (usage >= HID_USAGE_MODIFIER_FIRST) {
+        held_modifiers |= (uint8_t)(1 << (usage - HID_USAGE_MODIFIER_FIRST));
+        return;
+    }
+    for (int i = 0; i < HID_KEY_SLOTS; i++) {
+        if (held_keys[i] == 0) {
+            held_keys[i] = usage;
+            return;
+        }
+    }
+    // More than six keys held: the boot protocol cannot carry it, drop it
+}
+
+static void release_usage(uint8_t usage) {
+    if (usage >= HID_USAGE_MODIFIER_FIRST) {
+        held_modifiers &= (uint8_t)~(1 << (usage - HID_USAGE_MODIFIER_FIRST));
+        return;
+    }
+    for (int i = 0; i < HID_KEY_SLOTS; i++) {
+        if (held_keys[i] == usage) {
+            held_keys[i] = 0;
+            return;
+        }
+    }
+}
+
+static void send_keyboard_report(uint8_t modifiers, bool phantom) {
+    uint8_t keycodes[HID_KEY_SLOTS];
+    for (int i = 0; i < HID_KEY_SLOTS; i++) {
+        // Matrix ghosting: report ErrorRollOver in every slot (boot protocol phantom state)
+        keycodes[i] = phantom ? 0x01 : held_keys[i];
+    }
+    tud_hid_n_keyboard_report(USB_HID_ITF_KEYBOARD, 0, modifiers, keycodes);
+    sent_modifiers = modifiers;
+    sent_phantom = phantom;
+}
+
+// Apply one key event; returns true if the keyboard state changed
+static bool apply_key_event(uint8_t event, uint8_t key_status) {
+    uint8_t type = event_bus_decode_type(event);
+    uint8_t key_code = event_bus_decode_key_code(event);
+    bool fn_active = (key_status & (1 << MODIFIER_FN)) != 0;
+
+    if (key_code == KEY_CODE_MOUSE_BUTTON) {
+        if (type == KEY_EVENT_PRESS) {
+            if (fn_active) {
+                mouse_held_button = MOUSE_BUTTON_MIDDLE;
+            } else if (key_status & (1 << MODIFIER_SHIFT)) {
+                mouse_held_button = MOUSE_BUTTON_RIGHT;
+            } else {
+                mouse_held_button = MOUSE_BUTTON_LEFT;
+            }
+            mouse_buttons |= mouse_held_button;
+            mouse_buttons_dirty = true;
+        } else if (type == KEY_EVENT_RELEASE) {
+            mouse_buttons &= (uint8_t)~mouse_held_button;
+            mouse_held_button = 0;
+            mouse_buttons_dirty = true;
+        }
+        return false;
+    }
+
+    if (type == KEY_EVENT_PRESS) {
+        uint8_t usage = fn_active ? keymap_fn[key_code] : keymap_normal[key_code];
+        if (usage == 0 || held_usage[key_code] != 0) {
+            return false;
+        }
+        held_usage[key_code] = usage;
+        hold_usage(usage);
+        return true;
+    }
+
+    if (type == KEY_EVENT_RELEASE) {
+        uint8_t usage = held_usage[key_code];
+        if (usage == 0) {
+            return false;
+        }
+        held_usage[key_code] = 0;
+        release_usage(usage);
+        return true;
+    }
+
+    return false;  // HOLD: the host generates its own key repeat
+}
+
+static void keyboard_tick(void) {
+    if (!tud_hid_n_ready(USB_HID_ITF_KEYBOARD)) {
+        return;  // Events stay queued in the bus until the endpoint is free
+    }
+
+    uint8_t key_status = i2c_slave_read_register(I2C_REG_KEY_STATUS);
+    bool phantom = (key_status & I2C_KEY_STATUS_ROLLOVER) != 0;
+
+    // Report at most one key transition per frame so the host sees every
+    // press and release, even when both arrive within the same millisecond
+    while (true) {
+        if (pending_event == EVENT_BUS_NO_EVENT) {
+            pending_event = i2c_slave_read_register(I2C_REG_FIFO_ACCESS);
+            if (pending_event == EVENT_BUS_NO_EVENT) {
+                break;
+            }
+        }
+
+        // A mouse button change must wait for the mouse endpoint
+        if (event_bus_decode_key_code(pending_event) == KEY_CODE_MOUSE_BUTTON &&
+            mouse_buttons_dirty) {
+            break;
+        }
+
+        bool changed = apply_key_event(pending_event, key_status);
+        pending_event = EVENT_BUS_NO_EVENT;
+        if (changed) {
+            send_keyboard_report(held_modifiers | status_modifiers(key_status), phantom);
+            return;
+        }
+    }
+
+    // Modifier lock/sticky changes and ghosting are level states
+    uint8_t modifiers = held_modifiers | status_modifiers(key_status);
+    if (modifiers != sent_modifiers || phantom != sent_phantom) {
+        send_keyboard_report(modifiers, phantom);
+    }
+}
+
+static int8_t take_mouse_delta(int16_t *accum) {
+    int16_t delta = *accum;
+    if (delta > 127) {
+        delta = 127;
+    } else if (delta < -127) {
+        delta = -127;
+    }
+    *accum -= delta;
+    return (int8_t)delta;
+}
+
+static void mouse_tick(void) {
+    // Movement registers hold this tick's delta; accumulate until sent
+    mouse_accum_x += (int8_t)i2c_slave_read_register(I2C_REG_MOUSE_X);
+    mouse_accum_y += (int8_t)i2c_slave_read_register(I2C_REG_MOUSE_Y);
+
+    if (!mouse_buttons_dirty && mouse_accum_x == 0 && mouse_accum_y == 0) {
+        return;
+    }
+    if (!tud_hid_n_ready(USB_HID_ITF_MOUSE)) {
+        return;
+    }
+
+    int8_t x = take_mouse_delta(&mouse_accum_x);
+    int8_t y = take_mouse_delta(&mouse_accum_y);
+    tud_hid_n_mouse_report(USB_HID_ITF_MOUSE, 0, mouse_buttons, x, y, 0, 0);
+    mouse_buttons_dirty = false;
+}
+
+void usb_hid_init(void) {
+    for (int i = 0; i < KEY_CODE_COUNT; i++) {
+        held_usage[i] = 0;
+    }
+    for (int i = 0; i < HID_KEY_SLOTS; i++) {
+        held_keys[i] = 0;
+    }
+    held_modifiers = 0;
+    sent_modifiers = 0;
+    sent_phantom = false;
+    pending_event = EVENT_BUS_NO_EVENT;
+    mouse_accum_x = 0;
+    mouse_accum_y = 0;
+    mouse_buttons = 0;
+    mouse_held_button = 0;
+    mouse_buttons_dirty = false;
+
+    tusb_init();
+}
+
+void usb_hid_task(void) {
+    tud_task();
+}
+
+void usb_hid_tick(void) {
+    if (!tud_mounted()) {
+        return;
+    }
+
+    // Remote wakeup on input while the host is suspended
+    if (tud_suspended()) {
+        if (i2c_slave_get_interrupt_flags() != 0) {
+            tud_remote_wakeup();
+        }
+        return;
+    }
+
+    mouse_tick();
+    keyboard_tick();
+
+    // Interrupt flags only gate the I2C INT line; clear them like a host read
+    (void)i2c_slave_read_register(I2C_REG_INTERRUPT);
+}
+
+// TinyUSB HID callbacks
+
+uint16_t tud_hid_get_report_cb(uint8_t instance, uint8_t report_id, hid_report_type_t report_type,
+                               uint8_t *buffer, uint16_t reqlen) {
+    (void)instance;
+    (void)report_id;
+    (void)report_type;
+    (void)buffer;
+    (void)reqlen;
+    return 0;  // Not supported, the host uses the interrupt endpoints
+}
+
+void tud_hid_set_report_cb(uint8_t instance, uint8_t report_id, hid_report_type_t report_type,
+                           const uint8_t *buffer, uint16_t bufsize) {
+    // Keyboard LED output report (caps/num lock): there are no lock LEDs
+    (void)instance;
+    (void)report_id;
+    (void)report_type;
+    (void)buffer;
+    (void)bufsize;
+}
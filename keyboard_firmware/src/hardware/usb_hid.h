@@ -0,0 +1,34 @@
+#ifndef USB_HID_H
+#define USB_HID_H
+
+#include <stdint.h>
+
+// HID interface instances
+#define USB_HID_ITF_KEYBOARD 0
+#define USB_HID_ITF_MOUSE    1
+
+// Interrupt endpoint polling interval (1 ms at full speed = 1 kHz)
+#define USB_HID_POLL_INTERVAL_MS 1
+
+/**
+ * Initialize the USB device stack (composite HID keyboard + mouse).
+ * Key events and mouse deltas are taken from the I2C register map, so the
+ * register update functions in i2c_slave.h are used unchanged.
+ */
+void usb_hid_init(void);
+
+/**
+ * Run the USB device stack. Call on every main loop iteration.
+ */
+void usb_hid_task(void);
+
+/**
+ * Translate pending events into HID reports.
+ * One keyboard state change is reported per call, so presses and releases
+ * are never merged; remaining events wait in the event bus. Mouse motion
+ * accumulates while the endpoint is busy. Call once per tick after all
+ * registers have been updated.
+ */
+void usb_hid_tick(void);
+
+#endif  // USB_HID_H
@@ -7,6 +7,10 @@ void digital_mouse_init(digital_mouse_t *mouse, uint32_t update_interval_ms) {
     mouse->update_interval_ms = update_interval_ms;
 }
 
+void digital_mouse_set_interval(digital_mouse_t *mouse, uint32_t update_interval_ms) {
+    mouse->update_interval_ms = update_interval_ms;
+}
+
 void digital_mouse_update_button(digital_mouse_t *mouse, uint8_t fn_key_index, bool pressed) {
     // Map FN keys to mouse movement
     // FN12: Left movement
@@ -37,6 +37,14 @@ typedef struct {
  */
 void digital_mouse_init(digital_mouse_t *mouse, uint32_t update_interval_ms);
 
+/**
+ * Change the position update interval at runtime.
+ * 
+ * @param mouse Pointer to digital mouse state
+ * @param update_interval_ms Update interval for position accumulation
+ */
+void digital_mouse_set_interval(digital_mouse_t *mouse, uint32_t update_interval_ms);
+
 /**
  * Update mouse button state from FN key events.
  * 
@@ -0,0 +1,112 @@
+#include "event_bus.h"
+#include <stdatomic.h>
+#include <stddef.h>
+#include <string.h>
+
+void event_bus_init(event_bus_t *bus) {
+    memset(bus, 0, sizeof(event_bus_t));
+}
+
+void event_bus_set_filter(event_bus_t *bus, event_bus_filter_t filter, void *ctx) {
+    bus->filter = filter;
+    bus->filter_ctx = ctx;
+}
+
+bool event_bus_publish(event_bus_t *bus, uint8_t source, key_event_type_t type,
+                       uint8_t key_code, uint32_t now_ms) {
+    uint8_t tail = bus->tail;
+    bool full = (uint8_t)(tail - bus->head) >= EVENT_BUS_SIZE;
+
+    // Write the event in place; the scratch slot keeps the filter working
+    // (e.g. modifier tracking) even when the event itself will be dropped
+    key_event_t *slot = full ? &bus->scratch : &bus->events[tail & EVENT_BUS_MASK];
+    slot->time_ms = now_ms;
+    slot->type = (uint8_t)type;
+    slot->key_code = key_code;
+    slot->source = source;
+
+    if (bus->filter != NULL && !bus->filter(bus->filter_ctx, slot)) {
+        return true;  // Consumed locally
+    }
+
+    if (full) {
+        bus->overflow = true;
+        bus->dropped++;
+        if (source < EVENT_SOURCE_COUNT) {
+            bus->dropped_by_source[source]++;
+        }
+        return false;  // Bus full, drop newest
+    }
+
+    // Make the slot contents visible before the consumer sees the new tail
+    atomic_signal_fence(memory_order_release);
+    bus->tail = (uint8_t)(tail + 1);
+    bus->published++;
+
+    // The level only grows by one per publish, so equality marks the crossing
+    uint8_t level = (uint8_t)(bus->tail - bus->head);
+    if (level > bus->high_water) {
+        bus->high_water = level;
+    }
+    if (bus->watermark != 0 && level == bus->watermark) {
+        bus->watermark_hit = true;
+    }
+
+    return true;
+}
+
+uint8_t event_bus_pop(event_bus_t *bus) {
+    uint8_t head = bus->head;
+    if (head == bus->tail) {
+        return EVENT_BUS_NO_EVENT;  // Bus empty
+    }
+
+    atomic_signal_fence(memory_order_acquire);
+    const key_event_t *event = &bus->events[head & EVENT_BUS_MASK];
+    uint8_t entry = event_bus_encode(event->type, event->key_code);
+    bus->head = (uint8_t)(head + 1);
+
+    return entry;
+}
+
+const key_event_t *event_bus_peek(const event_bus_t *bus) {
+    uint8_t head = bus->head;
+    if (head == bus->tail) {
+        return NULL;
+    }
+
+    atomic_signal_fence(memory_order_acquire);
+    return &bus->events[head & EVENT_BUS_MASK];
+}
+
+uint8_t event_bus_count(const event_bus_t *bus) {
+    return (uint8_t)(bus->tail - bus->head);
+}
+
+bool event_bus_is_empty(const event_bus_t *bus) {
+    return bus->head == bus->tail;
+}
+
+bool event_bus_check_and_clear_overflow(event_bus_t *bus) {
+    bool had_overflow = bus->overflow;
+    bus->overflow = false;
+    return had_overflow;
+}
+
+void event_bus_set_watermark(event_bus_t *bus, uint8_t watermark) {
+    bus->watermark = watermark;
+}
+
+bool event_bus_check_and_clear_watermark(event_bus_t *bus) {
+    bool had_watermark = bus->watermark_hit;
+    bus->watermark_hit = false;
+    return had_watermark;
+}
+
+uint8_t event_bus_take_high_water(event_bus_t *bus) {
+    // A publish racing with this call can only leave a level that was
+    // really reached, so the next peak is never under-reported
+    uint8_t peak = bus->high_water;
+    bus->high_water = event_bus_count(bus);
+    return peak;
+}
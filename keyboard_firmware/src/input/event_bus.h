@@ -0,0 +1,208 @@
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Bus depth (must be a power of two)
+#define EVENT_BUS_SIZE 64
+#define EVENT_BUS_MASK (EVENT_BUS_SIZE - 1)
+
+// Wire encoding of an event as served over I2C:
+// Bits [1:0]: Event type (00=none, 01=press, 10=hold, 11=release)
+// Bits [7:2]: Key code (0-63 for 64 possible keys)
+#define EVENT_BUS_EVENT_TYPE_MASK    0x03
+#define EVENT_BUS_EVENT_TYPE_SHIFT   0
+#define EVENT_BUS_KEY_CODE_MASK      0xFC
+#define EVENT_BUS_KEY_CODE_SHIFT     2
+
+// Special value for "no event" when the bus is empty
+#define EVENT_BUS_NO_EVENT 0x00
+
+// Key event types (shared by all input sources)
+typedef enum {
+    KEY_EVENT_NONE = 0,
+    KEY_EVENT_PRESS = 1,
+    KEY_EVENT_HOLD = 2,
+    KEY_EVENT_RELEASE = 3
+} key_event_type_t;
+
+// Input sources publishing into the bus
+typedef enum {
+    EVENT_SOURCE_MATRIX = 0,
+    EVENT_SOURCE_FN,
+    EVENT_SOURCE_EXPANSION,   // Optional expansion matrix (e.g. number pad)
+    EVENT_SOURCE_COUNT
+} event_source_t;
+
+// Key event as stored in the bus
+typedef struct {
+    uint32_t time_ms;   // Time the event was published
+    uint8_t type;       // key_event_type_t
+    uint8_t key_code;   // Global key code (0-63)
+    uint8_t source;     // event_source_t
+} key_event_t;
+
+/**
+ * Event filter invoked on every published event before it is committed.
+ * Runs in the publisher's context with the event already written in place.
+ *
+ * @param ctx User context passed to event_bus_set_filter()
+ * @param event Event being published
+ * @return true to commit the event to the bus, false to consume it locally
+ */
+typedef bool (*event_bus_filter_t)(void *ctx, const key_event_t *event);
+
+// Event bus state
+// Single producer (main loop) / single consumer (I2C IRQ): head is only
+// written by the consumer and tail only by the producer, so no locking is
+// needed. Indices run free and are masked on access.
+typedef struct {
+    key_event_t events[EVENT_BUS_SIZE];
+    key_event_t scratch;        // Staging slot used while the bus is full
+    volatile uint8_t head;      // Read position (consumer)
+    volatile uint8_t tail;      // Write position (producer)
+
+    event_bus_filter_t filter;
+    void *filter_ctx;
+
+    // Overflow policy: drop the newest event and latch the overflow flag
+    bool overflow;              // Set when an event is dropped
+    uint32_t published;         // Events committed to the bus
+    uint32_t dropped;           // Events lost because the bus was full
+    uint32_t dropped_by_source[EVENT_SOURCE_COUNT];
+
+    // Back-pressure telemetry
+    uint8_t watermark;          // Occupancy that latches watermark_hit (0 = off)
+    bool watermark_hit;         // Set when the occupancy reaches the watermark
+    volatile uint8_t high_water; // Peak occupancy since event_bus_take_high_water()
+} event_bus_t;
+
+/**
+ * Initialize the event bus.
+ *
+ * @param bus Pointer to event bus state
+ */
+void event_bus_init(event_bus_t *bus);
+
+/**
+ * Install the filter that sees every event before it is committed.
+ *
+ * @param bus Pointer to event bus state
+ * @param filter Filter callback (NULL to commit everything)
+ * @param ctx User context passed to the filter
+ */
+void event_bus_set_filter(event_bus_t *bus, event_bus_filter_t filter, void *ctx);
+
+/**
+ * Publish a key event. The event is written directly into its bus slot.
+ *
+ * @param bus Pointer to event bus state
+ * @param source Publishing input source (EVENT_SOURCE_*)
+ * @param type Event type (KEY_EVENT_PRESS, etc.)
+ * @param key_code Key code (0-63)
+ * @param now_ms Current time in milliseconds
+ * @return false if the event was dropped because the bus is full
+ */
+bool event_bus_publish(event_bus_t *bus, uint8_t source, key_event_type_t type,
+                       uint8_t key_code, uint32_t now_ms);
+
+/**
+ * Pop the oldest event in wire encoding. Safe to call from IRQ context.
+ *
+ * @param bus Pointer to event bus state
+ * @return Encoded event, or EVENT_BUS_NO_EVENT if the bus is empty
+ */
+uint8_t event_bus_pop(event_bus_t *bus);
+
+/**
+ * Peek at the oldest event without removing it.
+ *
+ * @param bus Pointer to event bus state
+ * @return Pointer to the event slot, or NULL if the bus is empty
+ */
+const key_event_t *event_bus_peek(const event_bus_t *bus);
+
+/**
+ * Get the number of events in the bus.
+ *
+ * @param bus Pointer to event bus state
+ * @return Number of events (0-EVENT_BUS_SIZE)
+ */
+uint8_t event_bus_count(const event_bus_t *bus);
+
+/**
+ * Check if the bus is empty.
+ *
+ * @param bus Pointer to event bus state
+ * @return true if empty
+ */
+bool event_bus_is_empty(const event_bus_t *bus);
+
+/**
+ * Check if overflow occurred and clear the flag.
+ *
+ * @param bus Pointer to event bus state
+ * @return true if an event was dropped since last check
+ */
+bool event_bus_check_and_clear_overflow(event_bus_t *bus);
+
+/**
+ * Set the occupancy at which the watermark flag is latched.
+ *
+ * @param bus Pointer to event bus state
+ * @param watermark Number of queued events (0 disables the watermark)
+ */
+void event_bus_set_watermark(event_bus_t *bus, uint8_t watermark);
+
+/**
+ * Check if the occupancy reached the watermark and clear the flag.
+ * The flag is latched once per upward crossing, not while the level stays high.
+ *
+ * @param bus Pointer to event bus state
+ * @return true if the watermark was reached since last check
+ */
+bool event_bus_check_and_clear_watermark(event_bus_t *bus);
+
+/**
+ * Get the peak occupancy and restart tracking from the current level.
+ * Safe to call from IRQ context (consumer side).
+ *
+ * @param bus Pointer to event bus state
+ * @return Highest number of queued events since the previous call
+ */
+uint8_t event_bus_take_high_water(event_bus_t *bus);
+
+/**
+ * Encode an event entry for the wire.
+ *
+ * @param event_type Event type
+ * @param key_code Key code
+ * @return Encoded event entry
+ */
+static inline uint8_t event_bus_encode(uint8_t event_type, uint8_t key_code) {
+    return ((key_code << EVENT_BUS_KEY_CODE_SHIFT) & EVENT_BUS_KEY_CODE_MASK) |
+           ((event_type << EVENT_BUS_EVENT_TYPE_SHIFT) & EVENT_BUS_EVENT_TYPE_MASK);
+}
+
+/**
+ * Decode event type from a wire entry.
+ *
+ * @param entry Encoded event entry
+ * @return Event type
+ */
+static inline uint8_t event_bus_decode_type(uint8_t entry) {
+    return (entry & EVENT_BUS_EVENT_TYPE_MASK) >> EVENT_BUS_EVENT_TYPE_SHIFT;
+}
+
+/**
+ * Decode key code from a wire entry.
+ *
+ * @param entry Encoded event entry
+ * @return Key code
+ */
+static inline uint8_t event_bus_decode_key_code(uint8_t entry) {
+    return (entry & EVENT_BUS_KEY_CODE_MASK) >> EVENT_BUS_KEY_CODE_SHIFT;
+}
+
+#endif  // EVENT_BUS_H
@@ -3,103 +3,123 @@
 #include "pico/stdlib.h"
 #include <string.h>
 
-// Event queue for FN key events
-#define MAX_FN_EVENTS 16
-static fn_event_t fn_event_queue[MAX_FN_EVENTS];
-static uint8_t fn_event_queue_head = 0;
-static uint8_t fn_event_queue_tail = 0;
-static uint8_t fn_event_queue_count = 0;
-
-// Helper to add event to queue
-static bool queue_fn_event(fn_event_type_t type, uint8_t key_code) {
-    if (fn_event_queue_count >= MAX_FN_EVENTS) {
-        return false;  // Queue full
+// Build the GPIO -> key index remap table from the configured pin list.
+// Consecutive FN indices on consecutive GPIOs collapse into a single run.
+static void build_gpio_runs(fn_keys_t *fn_keys) {
+    fn_keys->run_count = 0;
+
+    for (int i = 0; i < FN_KEY_COUNT; i++) {
+        if (fn_keys->run_count > 0) {
+            fn_gpio_run_t *run = &fn_keys->runs[fn_keys->run_count - 1];
+            uint8_t run_len = (uint8_t)(i - run->index_shift);
+            if (fn_keys->gpios[i] == run->gpio_shift + run_len) {
+                run->bits = (uint16_t)((run->bits << 1) | 1);
+                continue;
+            }
+        }
+
+        fn_gpio_run_t *run = &fn_keys->runs[fn_keys->run_count++];
+        run->gpio_shift = fn_keys->gpios[i];
+        run->index_shift = (uint8_t)i;
+        run->bits = 1;
+    }
+}
+
+// Remap a raw GPIO sample into an 11-bit active-high key mask
+static inline uint16_t remap_sample(const fn_keys_t *fn_keys, uint32_t raw) {
+    uint32_t pressed = ~raw;  // Active low
+    uint16_t mask = 0;
+
+    for (int r = 0; r < fn_keys->run_count; r++) {
+        const fn_gpio_run_t *run = &fn_keys->runs[r];
+        mask |= (uint16_t)(((pressed >> run->gpio_shift) & run->bits) << run->index_shift);
+    }
+
+    return mask;
+}
+
+void fn_keys_set_debounce(fn_keys_t *fn_keys, uint32_t debounce_ms) {
+    fn_keys->debounce_ms = debounce_ms;
+
+    // Vertical counter saturates at 2^FN_DEBOUNCE_COUNTER_BITS - 1 samples
+    uint32_t max_ticks = (1u << FN_DEBOUNCE_COUNTER_BITS) - 1;
+    if (debounce_ms == 0) {
+        fn_keys->debounce_ticks = 1;
+    } else if (debounce_ms > max_ticks) {
+        fn_keys->debounce_ticks = (uint8_t)max_ticks;
+    } else {
+        fn_keys->debounce_ticks = (uint8_t)debounce_ms;
     }
-    
-    fn_event_queue[fn_event_queue_tail].type = type;
-    fn_event_queue[fn_event_queue_tail].key_code = key_code;
-    fn_event_queue_tail = (fn_event_queue_tail + 1) % MAX_FN_EVENTS;
-    fn_event_queue_count++;
-    
-    return true;
 }
 
-void fn_keys_init(fn_keys_t *fn_keys, const uint8_t *gpios, uint32_t debounce_ms) {
+void fn_keys_init(fn_keys_t *fn_keys, const uint8_t *gpios, uint32_t debounce_ms,
+                  event_bus_t *bus) {
     // Copy GPIO array
     memcpy(fn_keys->gpios, gpios, FN_KEY_COUNT);
-    fn_keys->debounce_ms = debounce_ms;
-    
-    // Initialize state arrays
-    memset(fn_keys->keys, 0, sizeof(fn_keys->keys));
-    
+    fn_keys->bus = bus;
+    fn_keys_set_debounce(fn_keys, debounce_ms);
+
+    // Initialize state masks
+    fn_keys->debounced = 0;
+    memset(fn_keys->counter, 0, sizeof(fn_keys->counter));
+
+    build_gpio_runs(fn_keys);
+
     // Configure all FN key GPIOs as inputs with pull-ups
     for (int i = 0; i < FN_KEY_COUNT; i++) {
         gpio_init(gpios[i]);
         gpio_set_dir(gpios[i], GPIO_IN);
         gpio_pull_up(gpios[i]);
     }
-    
-    // Clear event queue
-    fn_event_queue_head = 0;
-    fn_event_queue_tail = 0;
-    fn_event_queue_count = 0;
 }
 
 void fn_keys_tick(fn_keys_t *fn_keys, uint32_t now_ms) {
-    for (int i = 0; i < FN_KEY_COUNT; i++) {
-        fn_key_state_t *key = &fn_keys->keys[i];
-        
-        // Read current state (active low)
-        bool pressed = !gpio_get(fn_keys->gpios[i]);
-        key->current_state = pressed;
-        
-        // Debounce logic
-        if (pressed != key->previous_state) {
-            // State changed, reset timer
-            key->state_time = now_ms;
-            key->previous_state = pressed;
-        } else if ((now_ms - key->state_time) >= fn_keys->debounce_ms) {
-            // State stable for debounce period
-            bool old_debounced = key->debounced_state;
-            key->debounced_state = pressed;
-            
-            // Generate events on debounced state changes
-            uint8_t key_code = fn_keys_get_key_code(i);
-            
-            if (pressed && !old_debounced) {
-                // Key press
-                queue_fn_event(FN_EVENT_PRESS, key_code);
-                key->hold_emitted = false;
-            } else if (!pressed && old_debounced) {
-                // Key release
-                queue_fn_event(FN_EVENT_RELEASE, key_code);
-                key->hold_emitted = false;
-            } else if (pressed && old_debounced && !key->hold_emitted) {
-                // Check for hold event (key held for longer period)
-                if ((now_ms - key->state_time) >= 500) {  // 500ms hold threshold
-                    queue_fn_event(FN_EVENT_HOLD, key_code);
-                    key->hold_emitted = true;
-                }
-            }
+    // Sample all FN keys with a single GPIO read
+    uint16_t sample = remap_sample(fn_keys, gpio_get_all());
+
+    // Lanes whose raw level disagrees with the debounced level count up,
+    // all other lanes reset. A lane that reaches debounce_ticks flips.
+    uint16_t delta = sample ^ fn_keys->debounced;
+    uint16_t carry = delta;
+    uint16_t at_threshold = delta;
+
+    for (int b = 0; b < FN_DEBOUNCE_COUNTER_BITS; b++) {
+        uint16_t plane = fn_keys->counter[b] & delta;
+        uint16_t next = plane ^ carry;
+        carry &= plane;
+        fn_keys->counter[b] = next;
+
+        if (fn_keys->debounce_ticks & (1u << b)) {
+            at_threshold &= next;
+        } else {
+            at_threshold &= (uint16_t)~next;
         }
     }
-}
 
-bool fn_keys_get_event(fn_keys_t *fn_keys, fn_event_t *event) {
-    if (fn_event_queue_count == 0) {
-        return false;
+    uint16_t changed = at_threshold;
+    if (changed) {
+        fn_keys->debounced ^= changed;
+        for (int b = 0; b < FN_DEBOUNCE_COUNTER_BITS; b++) {
+            fn_keys->counter[b] &= (uint16_t)~changed;
+        }
+
+        // Generate events on debounced state changes
+        while (changed) {
+            int i = __builtin_ctz(changed);
+            uint16_t bit = (uint16_t)(1u << i);
+            changed &= (uint16_t)~bit;
+
+            // Key press or release
+            key_event_type_t type = (fn_keys->debounced & bit) ? KEY_EVENT_PRESS : KEY_EVENT_RELEASE;
+            event_bus_publish(fn_keys->bus, EVENT_SOURCE_FN, type,
+                              fn_keys_get_key_code(i), now_ms);
+        }
     }
-    
-    *event = fn_event_queue[fn_event_queue_head];
-    fn_event_queue_head = (fn_event_queue_head + 1) % MAX_FN_EVENTS;
-    fn_event_queue_count--;
-    
-    return true;
 }
 
 bool fn_keys_is_pressed(const fn_keys_t *fn_keys, uint8_t key_index) {
     if (key_index >= FN_KEY_COUNT) {
         return false;
     }
-    return fn_keys->keys[key_index].debounced_state;
+    return (fn_keys->debounced >> key_index) & 1;
 }
@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include "event_bus.h"
 
 // Number of independent FN keys (FN1-FN6, FN8-FN12 = 11 keys)
 #define FN_KEY_COUNT 11
@@ -23,34 +24,32 @@
 // Key codes for FN keys (start after matrix keys)
 #define FN_KEY_CODE_BASE 42  // 6 rows * 7 cols = 42
 
-// Key event types (same as matrix scanner)
-typedef enum {
-    FN_EVENT_NONE = 0,
-    FN_EVENT_PRESS = 1,
-    FN_EVENT_HOLD = 2,
-    FN_EVENT_RELEASE = 3
-} fn_event_type_t;
+// Vertical debounce counter depth (counts up to 255 scan ticks)
+#define FN_DEBOUNCE_COUNTER_BITS 8
 
-// FN key event structure
+// Contiguous run of FN GPIOs that maps onto contiguous key indices.
+// Lets a single gpio_get_all() sample be remapped with a few shift/mask ops.
 typedef struct {
-    fn_event_type_t type;
-    uint8_t key_code;
-} fn_event_t;
-
-// Per-key state
-typedef struct {
-    bool current_state;
-    bool previous_state;
-    uint32_t state_time;
-    bool debounced_state;
-    bool hold_emitted;
-} fn_key_state_t;
+    uint8_t gpio_shift;   // Lowest GPIO number in the run
+    uint8_t index_shift;  // FN key index of that GPIO
+    uint16_t bits;        // Right-aligned mask covering the run
+} fn_gpio_run_t;
 
 // FN keys manager state
+// All per-key state is held as 11-bit masks (bit i = FN key index i) so the
+// whole bank is debounced in parallel.
 typedef struct {
     uint8_t gpios[FN_KEY_COUNT];
     uint32_t debounce_ms;
-    fn_key_state_t keys[FN_KEY_COUNT];
+    event_bus_t *bus;  // Destination for key events
+
+    // Precomputed GPIO -> key index remap table
+    fn_gpio_run_t runs[FN_KEY_COUNT];
+    uint8_t run_count;
+
+    uint16_t debounced;      // Debounced pressed mask
+    uint8_t debounce_ticks;  // Consecutive samples required to accept a change
+    uint16_t counter[FN_DEBOUNCE_COUNTER_BITS];  // Vertical counter bit-planes
 } fn_keys_t;
 
 /**
@@ -59,26 +58,31 @@ typedef struct {
  * @param fn_keys Pointer to FN keys state
  * @param gpios Array of GPIO numbers for FN keys (in order FN1-FN6, FN8-FN12)
  * @param debounce_ms Debounce time in milliseconds
+ * @param bus Event bus that receives key events
  */
-void fn_keys_init(fn_keys_t *fn_keys, const uint8_t *gpios, uint32_t debounce_ms);
+void fn_keys_init(fn_keys_t *fn_keys, const uint8_t *gpios, uint32_t debounce_ms,
+                  event_bus_t *bus);
 
 /**
- * Update FN keys state and process events.
- * Must be called regularly (e.g., every 1ms).
+ * Change the debounce time at runtime.
+ * Lanes already counting keep their progress against the new threshold.
  * 
  * @param fn_keys Pointer to FN keys state
- * @param now_ms Current time in milliseconds
+ * @param debounce_ms Debounce time in milliseconds
  */
-void fn_keys_tick(fn_keys_t *fn_keys, uint32_t now_ms);
+void fn_keys_set_debounce(fn_keys_t *fn_keys, uint32_t debounce_ms);
 
 /**
- * Get the next pending FN key event.
+ * Update FN keys state and process events.
+ * Samples all FN GPIOs with one read and debounces them as a bitmask.
+ * Key events are published directly to the event bus.
+ * Must be called regularly (e.g., every 1ms); the debounce window is
+ * counted in calls, one per millisecond.
  * 
  * @param fn_keys Pointer to FN keys state
- * @param event Output event structure
- * @return true if an event was retrieved, false if no events pending
+ * @param now_ms Current time in milliseconds
  */
-bool fn_keys_get_event(fn_keys_t *fn_keys, fn_event_t *event);
+void fn_keys_tick(fn_keys_t *fn_keys, uint32_t now_ms);
 
 /**
  * Check if a specific FN key is currently pressed (debounced).
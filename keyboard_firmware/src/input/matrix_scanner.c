@@ -3,73 +3,131 @@
 #include "pico/stdlib.h"
 #include <string.h>
 
-// Event queue for pending events
-#define MAX_PENDING_EVENTS 32
-static key_event_t event_queue[MAX_PENDING_EVENTS];
-static uint8_t event_queue_head = 0;
-static uint8_t event_queue_tail = 0;
-static uint8_t event_queue_count = 0;
-
-// Helper to add event to queue
-static bool queue_event(key_event_type_t type, uint8_t key_code) {
-    if (event_queue_count >= MAX_PENDING_EVENTS) {
-        return false;  // Queue full
+// Key code of a matrix position within this instance's key code range
+static inline uint8_t instance_key_code(const matrix_scanner_t *scanner, int row, int col) {
+    return (uint8_t)(scanner->key_code_base + row * scanner->cols + col);
+}
+
+// Find ghost patterns in a diode-less matrix. Two columns that share two
+// or more pressed rows form a rectangle; any corner of it may be a ghost,
+// so all keys on the shared rows of both columns are marked ambiguous.
+// Costs cols*(cols-1)/2 AND/compare steps per scan (21 for 7 columns).
+static bool detect_ghosts(const uint8_t *col_rows, uint8_t cols, uint8_t *ghost_rows) {
+    bool ghosting = false;
+
+    memset(ghost_rows, 0, cols);
+    for (int c1 = 0; c1 < cols; c1++) {
+        uint8_t rows1 = col_rows[c1];
+        if ((rows1 & (rows1 - 1)) == 0) {
+            continue;  // Fewer than two keys in this column
+        }
+        for (int c2 = c1 + 1; c2 < cols; c2++) {
+            uint8_t shared = rows1 & col_rows[c2];
+            if (shared & (shared - 1)) {
+                ghost_rows[c1] |= shared;
+                ghost_rows[c2] |= shared;
+                ghosting = true;
+            }
+        }
     }
-    
-    event_queue[event_queue_tail].type = type;
-    event_queue[event_queue_tail].key_code = key_code;
-    event_queue_tail = (event_queue_tail + 1) % MAX_PENDING_EVENTS;
-    event_queue_count++;
-    
-    return true;
+
+    return ghosting;
 }
 
-void matrix_scanner_init(matrix_scanner_t *scanner, const uint8_t *row_gpios, 
-                        const uint8_t *col_gpios, uint32_t debounce_ms) {
-    // Copy GPIO arrays
-    memcpy(scanner->row_gpios, row_gpios, MATRIX_ROWS);
-    memcpy(scanner->col_gpios, col_gpios, MATRIX_COLS);
-    scanner->debounce_ms = debounce_ms;
-    
-    // Initialize state arrays
-    memset(scanner->current_state, 0, sizeof(scanner->current_state));
-    memset(scanner->previous_state, 0, sizeof(scanner->previous_state));
-    memset(scanner->state_time, 0, sizeof(scanner->state_time));
-    memset(scanner->debounced_state, 0, sizeof(scanner->debounced_state));
-    memset(scanner->hold_emitted, 0, sizeof(scanner->hold_emitted));
+bool matrix_scanner_init(matrix_scanner_t *scanner, const matrix_scanner_config_t *config,
+                         event_bus_t *bus) {
+    memset(scanner, 0, sizeof(matrix_scanner_t));
+
+    // Validate geometry and key code range
+    if (config->rows == 0 || config->rows > MATRIX_MAX_ROWS ||
+        config->cols == 0 || config->cols > MATRIX_MAX_COLS) {
+        return false;
+    }
+    if ((uint32_t)config->key_code_base + config->rows * config->cols > MATRIX_KEY_CODE_LIMIT) {
+        return false;
+    }
+
+    // Copy GPIO arrays and configuration
+    memcpy(scanner->row_gpios, config->row_gpios, config->rows);
+    memcpy(scanner->col_gpios, config->col_gpios, config->cols);
+    scanner->rows = config->rows;
+    scanner->cols = config->cols;
+    scanner->key_code_base = config->key_code_base;
+    scanner->source = config->source;
+    scanner->debounce_ms = config->debounce_ms;
+    scanner->scan_interval_ms = config->scan_interval_ms;
+    scanner->bus = bus;
     
     // Configure column GPIOs as outputs (drive low when scanning)
-    for (int col = 0; col < MATRIX_COLS; col++) {
-        gpio_init(col_gpios[col]);
-        gpio_set_dir(col_gpios[col], GPIO_OUT);
-        gpio_put(col_gpios[col], 1);  // Set high (inactive)
+    for (int col = 0; col < scanner->cols; col++) {
+        gpio_init(scanner->col_gpios[col]);
+        gpio_set_dir(scanner->col_gpios[col], GPIO_OUT);
+        gpio_put(scanner->col_gpios[col], 1);  // Set high (inactive)
     }
     
     // Configure row GPIOs as inputs with pull-ups
-    for (int row = 0; row < MATRIX_ROWS; row++) {
-        gpio_init(row_gpios[row]);
-        gpio_set_dir(row_gpios[row], GPIO_IN);
-        gpio_pull_up(row_gpios[row]);
+    for (int row = 0; row < scanner->rows; row++) {
+        gpio_init(scanner->row_gpios[row]);
+        gpio_set_dir(scanner->row_gpios[row], GPIO_IN);
+        gpio_pull_up(scanner->row_gpios[row]);
     }
-    
-    // Clear event queue
-    event_queue_head = 0;
-    event_queue_tail = 0;
-    event_queue_count = 0;
+
+    return true;
 }
 
 void matrix_scanner_tick(matrix_scanner_t *scanner, uint32_t now_ms) {
-    // Scan each column
-    for (int col = 0; col < MATRIX_COLS; col++) {
+    // Inactive instance (failed init)
+    if (scanner->bus == NULL) {
+        return;
+    }
+
+    // Check if it's time for this instance to scan
+    if ((now_ms - scanner->last_scan_ms) < scanner->scan_interval_ms) {
+        return;
+    }
+    scanner->last_scan_ms = now_ms;
+
+    // Sample the matrix: one row bitmask per column
+    uint8_t col_rows[MATRIX_MAX_COLS];
+    for (int col = 0; col < scanner->cols; col++) {
         // Activate this column (drive low)
         gpio_put(scanner->col_gpios[col], 0);
         
         // Small delay to let signals settle
         busy_wait_us(1);
         
-        // Read all rows
-        for (int row = 0; row < MATRIX_ROWS; row++) {
-            bool pressed = !gpio_get(scanner->row_gpios[row]);  // Active low
+        // Read all rows with a single GPIO access (active low)
+        uint32_t raw = gpio_get_all();
+        uint8_t rows = 0;
+        for (int row = 0; row < scanner->rows; row++) {
+            if (!(raw & (1u << scanner->row_gpios[row]))) {
+                rows |= (uint8_t)(1u << row);
+            }
+        }
+        col_rows[col] = rows;
+        
+        // Deactivate this column (drive high)
+        gpio_put(scanner->col_gpios[col], 1);
+    }
+
+    // Mark ghost-ambiguous keys for this scan
+    uint8_t ghost_rows[MATRIX_MAX_COLS];
+    bool ghosting = detect_ghosts(col_rows, scanner->cols, ghost_rows);
+    if (ghosting && !scanner->ghosting) {
+        scanner->ghost_events++;
+    }
+    scanner->ghosting = ghosting;
+
+    // Debounce and generate events
+    for (int col = 0; col < scanner->cols; col++) {
+        for (int row = 0; row < scanner->rows; row++) {
+            bool pressed = (col_rows[col] >> row) & 1;
+            
+            // Ambiguous keys keep their debounced state until the
+            // ghost pattern clears
+            if ((ghost_rows[col] >> row) & 1) {
+                pressed = scanner->debounced_state[row][col];
+            }
             
             scanner->current_state[row][col] = pressed;
             
@@ -86,44 +144,53 @@ void matrix_scanner_tick(matrix_scanner_t *scanner, uint32_t now_ms) {
                 // Generate events on debounced state changes
                 if (pressed && !old_debounced) {
                     // Key press
-                    uint8_t key_code = matrix_get_key_code(row, col);
-                    queue_event(KEY_EVENT_PRESS, key_code);
-                    scanner->hold_emitted[row][col] = false;
+                    uint8_t key_code = instance_key_code(scanner, row, col);
+                    event_bus_publish(scanner->bus, scanner->source, KEY_EVENT_PRESS,
+                                      key_code, now_ms);
                 } else if (!pressed && old_debounced) {
                     // Key release
-                    uint8_t key_code = matrix_get_key_code(row, col);
-                    queue_event(KEY_EVENT_RELEASE, key_code);
-                    scanner->hold_emitted[row][col] = false;
-                } else if (pressed && old_debounced && !scanner->hold_emitted[row][col]) {
-                    // Check for hold event (key held for longer period)
-                    if ((now_ms - scanner->state_time[row][col]) >= 500) {  // 500ms hold threshold
-                        uint8_t key_code = matrix_get_key_code(row, col);
-                        queue_event(KEY_EVENT_HOLD, key_code);
-                        scanner->hold_emitted[row][col] = true;
-                    }
+                    uint8_t key_code = instance_key_code(scanner, row, col);
+                    event_bus_publish(scanner->bus, scanner->source, KEY_EVENT_RELEASE,
+                                      key_code, now_ms);
                 }
             }
         }
-        
-        // Deactivate this column (drive high)
-        gpio_put(scanner->col_gpios[col], 1);
     }
 }
 
-bool matrix_scanner_get_event(matrix_scanner_t *scanner, key_event_t *event) {
-    if (event_queue_count == 0) {
-        return false;
+uint32_t matrix_scanner_arm_wake(matrix_scanner_t *scanner, bool armed) {
+    if (scanner->bus == NULL) {
+        return 0;
     }
-    
-    *event = event_queue[event_queue_head];
-    event_queue_head = (event_queue_head + 1) % MAX_PENDING_EVENTS;
-    event_queue_count--;
-    
-    return true;
+
+    for (int col = 0; col < scanner->cols; col++) {
+        gpio_put(scanner->col_gpios[col], armed ? 0 : 1);
+    }
+
+    uint32_t row_mask = 0;
+    for (int row = 0; row < scanner->rows; row++) {
+        row_mask |= 1u << scanner->row_gpios[row];
+    }
+    if (armed) {
+        busy_wait_us(1);  // Same settling time as a scan
+    }
+    return row_mask;
+}
+
+void matrix_scanner_set_debounce(matrix_scanner_t *scanner, uint32_t debounce_ms) {
+    scanner->debounce_ms = debounce_ms;
+}
+
+bool matrix_scanner_is_ghosting(const matrix_scanner_t *scanner) {
+    return scanner->ghosting;
+}
+
+uint32_t matrix_scanner_get_ghost_count(const matrix_scanner_t *scanner) {
+    return scanner->ghost_events;
 }
 
 bool matrix_scanner_is_key_pressed(const matrix_scanner_t *scanner, uint8_t row, uint8_t col) {
-    if (row >= MATRIX_ROWS || col >= MATRIX_COLS) {
+    if (row >= scanner->rows || col >= scanner->cols) {
         return false;
     }
     return scanner->debounced_state[row][col];
@@ -3,53 +3,74 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include "event_bus.h"
 
-// Matrix dimensions
+// Main keyboard matrix dimensions
 #define MATRIX_ROWS 6
 #define MATRIX_COLS 7
 
-// Key event types
-typedef enum {
-    KEY_EVENT_NONE = 0,
-    KEY_EVENT_PRESS = 1,
-    KEY_EVENT_HOLD = 2,
-    KEY_EVENT_RELEASE = 3
-} key_event_type_t;
+// Largest matrix a single scanner instance can drive
+#define MATRIX_MAX_ROWS 8
+#define MATRIX_MAX_COLS 8
 
-// Key event structure
+// Key codes are 6 bits on the wire (see event_bus.h)
+#define MATRIX_KEY_CODE_LIMIT 64
+
+// Scanner instance configuration
 typedef struct {
-    key_event_type_t type;
-    uint8_t key_code;  // Row * MATRIX_COLS + Col
-} key_event_t;
+    const uint8_t *row_gpios;   // Row GPIO numbers (inputs, pulled up)
+    const uint8_t *col_gpios;   // Column GPIO numbers (outputs, driven low to scan)
+    uint8_t rows;               // Number of rows (1-MATRIX_MAX_ROWS)
+    uint8_t cols;               // Number of columns (1-MATRIX_MAX_COLS)
+    uint8_t key_code_base;      // Key code of row 0, col 0
+    uint8_t source;             // Event source tag (EVENT_SOURCE_*)
+    uint32_t debounce_ms;       // Debounce time in milliseconds
+    uint32_t scan_interval_ms;  // Minimum time between scans (0 = every tick)
+} matrix_scanner_config_t;
 
 // Matrix scanner state
+// All state is per instance, so several matrices can be scanned
+// independently and feed the same event bus.
 typedef struct {
-    uint8_t row_gpios[MATRIX_ROWS];
-    uint8_t col_gpios[MATRIX_COLS];
+    uint8_t row_gpios[MATRIX_MAX_ROWS];
+    uint8_t col_gpios[MATRIX_MAX_COLS];
+    uint8_t rows;
+    uint8_t cols;
+    uint8_t key_code_base;
+    uint8_t source;
     uint32_t debounce_ms;
+    uint32_t scan_interval_ms;
+    uint32_t last_scan_ms;
+    event_bus_t *bus;  // Destination for key events
     
     // Per-key state
-    bool current_state[MATRIX_ROWS][MATRIX_COLS];
-    bool previous_state[MATRIX_ROWS][MATRIX_COLS];
-    uint32_t state_time[MATRIX_ROWS][MATRIX_COLS];
-    bool debounced_state[MATRIX_ROWS][MATRIX_COLS];
-    bool hold_emitted[MATRIX_ROWS][MATRIX_COLS];
+    bool current_state[MATRIX_MAX_ROWS][MATRIX_MAX_COLS];
+    bool previous_state[MATRIX_MAX_ROWS][MATRIX_MAX_COLS];
+    uint32_t state_time[MATRIX_MAX_ROWS][MATRIX_MAX_COLS];
+    bool debounced_state[MATRIX_MAX_ROWS][MATRIX_MAX_COLS];
+
+    // Anti-ghosting (the matrix has no diodes)
+    bool ghosting;           // Ghost pattern present in the last scan
+    uint32_t ghost_events;   // Number of scans that entered a ghost pattern
 } matrix_scanner_t;
 
 /**
- * Initialize the matrix scanner.
+ * Initialize a matrix scanner instance.
  * 
  * @param scanner Pointer to scanner state
- * @param row_gpios Array of row GPIO numbers
- * @param col_gpios Array of column GPIO numbers
- * @param debounce_ms Debounce time in milliseconds
+ * @param config Matrix geometry, key code range and timing
+ * @param bus Event bus that receives key events
+ * @return false if the geometry is too large or the key codes exceed
+ *         MATRIX_KEY_CODE_LIMIT (the scanner is left inactive)
  */
-void matrix_scanner_init(matrix_scanner_t *scanner, const uint8_t *row_gpios, 
-                        const uint8_t *col_gpios, uint32_t debounce_ms);
+bool matrix_scanner_init(matrix_scanner_t *scanner, const matrix_scanner_config_t *config,
+                         event_bus_t *bus);
 
 /**
  * Scan the matrix and update internal state.
- * Must be called regularly (e.g., every 1ms).
+ * Key events are published directly to the scanner's event bus.
+ * Must be called regularly (e.g., every 1ms); scans are skipped until
+ * the instance's scan interval has elapsed.
  * 
  * @param scanner Pointer to scanner state
  * @param now_ms Current time in milliseconds
@@ -57,26 +78,54 @@ void matrix_scanner_init(matrix_scanner_t *scanner, const uint8_t *row_gpios,
 void matrix_scanner_tick(matrix_scanner_t *scanner, uint32_t now_ms);
 
 /**
- * Get the next pending key event.
+ * Prepare the matrix for low-power mode: with every column driven low any
+ * key press pulls its row low, so the rows can act as wake pins. Disarming
+ * returns the columns to the idle (high) level used between scans.
  * 
  * @param scanner Pointer to scanner state
- * @param event Output event structure
- * @return true if an event was retrieved, false if no events pending
+ * @param armed true to drive all columns low, false to release them
+ * @return Mask of the row GPIOs (0 for an inactive instance)
  */
-bool matrix_scanner_get_event(matrix_scanner_t *scanner, key_event_t *event);
+uint32_t matrix_scanner_arm_wake(matrix_scanner_t *scanner, bool armed);
+
+/**
+ * Change the debounce time at runtime.
+ * 
+ * @param scanner Pointer to scanner state
+ * @param debounce_ms Debounce time in milliseconds
+ */
+void matrix_scanner_set_debounce(matrix_scanner_t *scanner, uint32_t debounce_ms);
+
+/**
+ * Check if the last scan found a ghost pattern (three pressed keys forming
+ * a rectangle corner). Keys of the rectangle hold their debounced state
+ * until the pattern clears.
+ * 
+ * @param scanner Pointer to scanner state
+ * @return true if the rollover limit is currently exceeded
+ */
+bool matrix_scanner_is_ghosting(const matrix_scanner_t *scanner);
+
+/**
+ * Get the number of times a ghost pattern appeared since init.
+ * 
+ * @param scanner Pointer to scanner state
+ * @return Ghost episode count
+ */
+uint32_t matrix_scanner_get_ghost_count(const matrix_scanner_t *scanner);
 
 /**
  * Check if a specific key is currently pressed (debounced).
  * 
  * @param scanner Pointer to scanner state
- * @param row Row index (0-5)
- * @param col Column index (0-6)
+ * @param row Row index (0 to rows-1)
+ * @param col Column index (0 to cols-1)
  * @return true if key is pressed
  */
 bool matrix_scanner_is_key_pressed(const matrix_scanner_t *scanner, uint8_t row, uint8_t col);
 
 /**
- * Get key code from row and column.
+ * Get key code from row and column of the main keyboard matrix.
  * 
  * @param row Row index (0-5)
  * @param col Column index (0-6)
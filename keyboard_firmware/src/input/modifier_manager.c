@@ -21,6 +21,13 @@ void modifier_manager_init(modifier_manager_t *manager, uint8_t fn_key_code,
     manager->active_modifier_mask = 0;
 }
 
+void modifier_manager_set_double_press_window(modifier_manager_t *manager,
+                                              uint32_t double_press_window_ms) {
+    for (int i = 0; i < MODIFIER_COUNT; i++) {
+        manager->modifiers[i].double_press_window_ms = double_press_window_ms;
+    }
+}
+
 // Helper to find modifier by key code
 static int8_t find_modifier_index(const modifier_manager_t *manager, uint8_t key_code) {
     for (int i = 0; i < MODIFIER_COUNT; i++) {
@@ -47,6 +47,15 @@ void modifier_manager_init(modifier_manager_t *manager, uint8_t fn_key_code,
                           uint8_t alt_key_code, uint8_t shift_key_code,
                           uint32_t double_press_window_ms);
 
+/**
+ * Change the double-press window of all modifiers at runtime.
+ * 
+ * @param manager Pointer to modifier manager state
+ * @param double_press_window_ms Time window for double-press detection
+ */
+void modifier_manager_set_double_press_window(modifier_manager_t *manager,
+                                              uint32_t double_press_window_ms);
+
 /**
  * Process a key press event.
  * 
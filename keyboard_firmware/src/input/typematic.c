@@ -0,0 +1,64 @@
+#include "typematic.h"
+#include <string.h>
+
+void typematic_init(typematic_t *typematic, uint32_t delay_ms, uint32_t interval_ms,
+                    event_bus_t *bus) {
+    memset(typematic, 0, sizeof(typematic_t));
+    typematic->delay_ms = delay_ms;
+    typematic->interval_ms = interval_ms;
+    typematic->bus = bus;
+}
+
+void typematic_set_params(typematic_t *typematic, uint32_t delay_ms, uint32_t interval_ms) {
+    typematic->delay_ms = delay_ms;
+    typematic->interval_ms = interval_ms;
+}
+
+void typematic_key_down(typematic_t *typematic, uint8_t key_code, uint8_t source, uint32_t press_ms) {
+    if (key_code >= TYPEMATIC_MAX_KEYS) {
+        return;
+    }
+
+    typematic->held_mask |= (1ULL << key_code);
+    typematic->next_repeat_ms[key_code] = press_ms + typematic->delay_ms;
+    typematic->source[key_code] = source;
+}
+
+void typematic_key_up(typematic_t *typematic, uint8_t key_code) {
+    if (key_code >= TYPEMATIC_MAX_KEYS) {
+        return;
+    }
+
+    typematic->held_mask &= ~(1ULL << key_code);
+}
+
+void typematic_tick(typematic_t *typematic, uint32_t now_ms) {
+    uint64_t pending = typematic->held_mask;
+
+    while (pending) {
+        uint8_t key_code = (uint8_t)__builtin_ctzll(pending);
+        pending &= pending - 1;
+
+        uint32_t due_ms = typematic->next_repeat_ms[key_code];
+        if ((int32_t)(now_ms - due_ms) < 0) {
+            continue;  // Not due yet
+        }
+
+        event_bus_publish(typematic->bus, typematic->source[key_code], KEY_EVENT_HOLD,
+                          key_code, due_ms);
+
+        if (typematic->interval_ms == 0) {
+            // Single hold event per press
+            typematic->held_mask &= ~(1ULL << key_code);
+            continue;
+        }
+
+        // Keep the cadence anchored to the schedule, but never replay a
+        // backlog of missed repeats after a stall
+        due_ms += typematic->interval_ms;
+        if ((int32_t)(now_ms - due_ms) >= 0) {
+            due_ms = now_ms + typematic->interval_ms;
+        }
+        typematic->next_repeat_ms[key_code] = due_ms;
+    }
+}
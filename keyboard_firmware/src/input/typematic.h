@@ -0,0 +1,72 @@
+#ifndef TYPEMATIC_H
+#define TYPEMATIC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "event_bus.h"
+
+// Number of key codes tracked (matches the 6-bit wire key code)
+#define TYPEMATIC_MAX_KEYS 64
+
+// Typematic repeat engine state
+// Keys are armed when a press is committed to the bus and emit
+// KEY_EVENT_HOLD events, first after delay_ms and then every interval_ms,
+// until released. Each repeat is timestamped with its scheduled time so
+// the cadence seen by the host does not depend on scan or poll jitter.
+typedef struct {
+    uint32_t delay_ms;      // Time from press to first repeat
+    uint32_t interval_ms;   // Time between repeats (0 = single hold event)
+    uint64_t held_mask;     // Bit n set while key code n is armed
+    uint32_t next_repeat_ms[TYPEMATIC_MAX_KEYS];
+    uint8_t source[TYPEMATIC_MAX_KEYS];
+    event_bus_t *bus;       // Destination for repeat events
+} typematic_t;
+
+/**
+ * Initialize the typematic engine.
+ *
+ * @param typematic Pointer to typematic state
+ * @param delay_ms Delay before the first repeat
+ * @param interval_ms Interval between repeats (0 = emit only one hold event)
+ * @param bus Event bus that receives repeat events
+ */
+void typematic_init(typematic_t *typematic, uint32_t delay_ms, uint32_t interval_ms,
+                    event_bus_t *bus);
+
+/**
+ * Change delay and rate. Applies to keys pressed after the call.
+ *
+ * @param typematic Pointer to typematic state
+ * @param delay_ms Delay before the first repeat
+ * @param interval_ms Interval between repeats (0 = emit only one hold event)
+ */
+void typematic_set_params(typematic_t *typematic, uint32_t delay_ms, uint32_t interval_ms);
+
+/**
+ * Arm repeat for a key that was pressed.
+ *
+ * @param typematic Pointer to typematic state
+ * @param key_code Key code that was pressed
+ * @param source Event source of the key
+ * @param press_ms Time of the press event
+ */
+void typematic_key_down(typematic_t *typematic, uint8_t key_code, uint8_t source, uint32_t press_ms);
+
+/**
+ * Stop repeat for a key that was released.
+ *
+ * @param typematic Pointer to typematic state
+ * @param key_code Key code that was released
+ */
+void typematic_key_up(typematic_t *typematic, uint8_t key_code);
+
+/**
+ * Publish any repeat events that are due.
+ * Must be called regularly (e.g., every 1ms).
+ *
+ * @param typematic Pointer to typematic state
+ * @param now_ms Current time in milliseconds
+ */
+void typematic_tick(typematic_t *typematic, uint32_t now_ms);
+
+#endif  // TYPEMATIC_H
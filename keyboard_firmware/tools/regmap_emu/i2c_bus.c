@@ -0,0 +1,276 @@
+#include "i2c_bus.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hardware/dma.h"
+#include "hardware/flash.h"
+#include "hardware/gpio.h"
+#include "hardware/i2c.h"
+#include "hardware/irq.h"
+
+#define GPIO_COUNT 30
+#define NO_DATA 0xFFFFFFFFu
+#define TX_FIFO_DEPTH 16
+#define RD_REQ_ATTEMPTS 2  // A request left unanswered is raised once more
+
+// Peripheral state
+static i2c_hw_t i2c0_hw;
+i2c_inst_t i2c0_inst = { .hw = &i2c0_hw };
+
+static irq_handler_t i2c_irq_handler = NULL;
+static uint32_t irq_count = 0;
+static bool gpio_level[GPIO_COUNT];
+
+// Single DMA channel feeding DATA_CMD through the TX FIFO
+static const volatile uint16_t *dma_source = NULL;
+static uint32_t dma_remaining = 0;
+static bool dma_claimed = false;
+
+// TX FIFO. Bytes left over by a NACKed read stay queued until the next read
+// command, which flushes them and raises TX_ABRT together with RD_REQ.
+// Writes are discarded until the abort is cleared. The clear is a register
+// read the emulator cannot see; the firmware aborts the DMA channel right
+// before it, so that call ends the flush.
+static uint8_t tx_fifo[TX_FIFO_DEPTH];
+static uint32_t tx_fifo_head = 0;
+static uint32_t tx_fifo_count = 0;
+static bool tx_flushed = false;
+
+static void tx_fifo_push(uint8_t byte) {
+    if (tx_flushed || tx_fifo_count == TX_FIFO_DEPTH) {
+        return;
+    }
+    tx_fifo[(tx_fifo_head + tx_fifo_count) % TX_FIFO_DEPTH] = byte;
+    tx_fifo_count++;
+}
+
+static uint8_t tx_fifo_pop(void) {
+    uint8_t byte = tx_fifo[tx_fifo_head];
+    tx_fifo_head = (tx_fifo_head + 1) % TX_FIFO_DEPTH;
+    tx_fifo_count--;
+    return byte;
+}
+
+// DMA runs while its DREQ (room in the FIFO) is active; into a flushed FIFO
+// every word is accepted and dropped
+static void dma_fill(void) {
+    while (dma_remaining > 0 && (tx_flushed || tx_fifo_count < TX_FIFO_DEPTH)) {
+        tx_fifo_push((uint8_t)*dma_source++);
+        dma_remaining--;
+    }
+}
+
+static void raise_irq(uint32_t status) {
+    if (i2c_irq_handler == NULL || (i2c0_hw.intr_mask & status) == 0) {
+        return;
+    }
+    i2c0_hw.intr_stat = status & i2c0_hw.intr_mask;
+    irq_count++;
+    i2c_irq_handler();
+    i2c0_hw.intr_stat = 0;
+}
+
+void i2c_bus_write(const uint8_t *data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        i2c0_hw.data_cmd = data[i] | (i == 0 ? I2C_IC_DATA_CMD_FIRST_DATA_BYTE_BITS : 0);
+        i2c0_hw.rxflr = 1;
+        raise_irq(I2C_IC_INTR_STAT_R_RX_FULL_BITS);
+        i2c0_hw.rxflr = 0;
+    }
+}
+
+// RD_REQ, raised while the TX FIFO is empty; a byte the handler writes to
+// DATA_CMD goes through the FIFO like the DMA words
+static void request_byte(uint32_t extra_status) {
+    i2c0_hw.data_cmd = NO_DATA;
+    raise_irq(I2C_IC_INTR_STAT_R_RD_REQ_BITS | extra_status);
+    if (i2c0_hw.data_cmd != NO_DATA) {
+        tx_fifo_push((uint8_t)i2c0_hw.data_cmd);
+    }
+    dma_fill();
+}
+
+bool i2c_bus_read(uint8_t *data, size_t len) {
+    bool ok = true;
+    uint32_t abort = 0;
+
+    // Stale bytes from a NACKed read: flushed by this read command
+    if (tx_fifo_count > 0) {
+        tx_fifo_count = 0;
+        tx_flushed = true;
+        abort = I2C_IC_INTR_STAT_R_TX_ABRT_BITS;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        for (int attempt = 0; tx_fifo_count == 0 && attempt < RD_REQ_ATTEMPTS; attempt++) {
+            request_byte(abort);
+            abort = 0;
+        }
+
+        if (tx_fifo_count > 0) {
+            data[i] = tx_fifo_pop();
+            dma_fill();
+        } else {
+            data[i] = 0xFF;  // Slave never answered; a real bus would hang here
+            ok = false;
+        }
+    }
+
+    // NACK: whatever DMA already queued stays in the FIFO
+    return ok;
+}
+
+void i2c_bus_stop(void) {
+    raise_irq(I2C_IC_INTR_STAT_R_STOP_DET_BITS);
+}
+
+bool i2c_bus_gpio_level(unsigned gpio) {
+    return gpio < GPIO_COUNT ? gpio_level[gpio] : false;
+}
+
+uint32_t i2c_bus_irq_count(void) {
+    return irq_count;
+}
+
+// Pico SDK functions used by the firmware sources
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) {
+    (void)i2c;
+    return baudrate;
+}
+
+uint i2c_get_dreq(i2c_inst_t *i2c, bool is_tx) {
+    (void)i2c;
+    return is_tx ? 32 : 33;  // DREQ_I2C0_TX / DREQ_I2C0_RX
+}
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+    if (num == I2C0_IRQ) {
+        i2c_irq_handler = handler;
+    }
+}
+
+void irq_set_enabled(uint num, bool enabled) {
+    (void)num;
+    (void)enabled;
+}
+
+void gpio_init(uint gpio) {
+    gpio_put(gpio, false);
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+    (void)gpio;
+    (void)out;
+}
+
+void gpio_put(uint gpio, bool value) {
+    if (gpio < GPIO_COUNT) {
+        gpio_level[gpio] = value;
+    }
+}
+
+bool gpio_get(uint gpio) {
+    return i2c_bus_gpio_level(gpio);
+}
+
+void gpio_pull_up(uint gpio) {
+    (void)gpio;
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn) {
+    (void)gpio;
+    (void)fn;
+}
+
+int dma_claim_unused_channel(bool required) {
+    if (dma_claimed) {
+        if (required) {
+            fprintf(stderr, "i2c_bus: only one DMA channel is emulated\n");
+            abort();
+        }
+        return -1;
+    }
+    dma_claimed = true;
+    return 0;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+    (void)channel;
+    return (dma_channel_config){ 0 };
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size) {
+    if (size != DMA_SIZE_16) {
+        fprintf(stderr, "i2c_bus: DATA_CMD DMA must use 16-bit transfers\n");
+        abort();
+    }
+    (void)c;
+}
+
+void channel_config_set_read_increment(dma_channel_config *c, bool incr) {
+    (void)c;
+    (void)incr;
+}
+
+void channel_config_set_write_increment(dma_channel_config *c, bool incr) {
+    (void)c;
+    (void)incr;
+}
+
+void channel_config_set_dreq(dma_channel_config *c, uint dreq) {
+    (void)c;
+    (void)dreq;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger) {
+    (void)channel;
+    (void)config;
+    (void)write_addr;
+    dma_source = (const volatile uint16_t *)read_addr;
+    dma_remaining = trigger ? transfer_count : 0;
+    dma_fill();
+}
+
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr,
+                                          uint32_t transfer_count) {
+    (void)channel;
+    dma_source = (const volatile uint16_t *)read_addr;
+    dma_remaining = transfer_count;
+    dma_fill();
+}
+
+bool dma_channel_is_busy(uint channel) {
+    (void)channel;
+    return dma_remaining > 0;
+}
+
+void dma_channel_abort(uint channel) {
+    (void)channel;
+    dma_remaining = 0;
+    tx_flushed = false;
+}
+
+// Flash contents start erased, like a blank device
+uint8_t emu_flash[PICO_FLASH_SIZE_BYTES];
+
+static void flash_init_erased(void) __attribute__((constructor));
+static void flash_init_erased(void) {
+    memset(emu_flash, 0xFF, sizeof(emu_flash));
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+    if (flash_offs + count <= sizeof(emu_flash)) {
+        memset(&emu_flash[flash_offs], 0xFF, count);
+    }
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count) {
+    // Programming can only clear bits
+    for (size_t i = 0; i < count && flash_offs + i < sizeof(emu_flash); i++) {
+        emu_flash[flash_offs + i] &= data[i];
+    }
+}
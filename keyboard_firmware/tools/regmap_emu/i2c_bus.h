@@ -0,0 +1,50 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Bus master side of the emulated I2C0 peripheral. Each call raises the
+// same interrupts the DW_apb_i2c block would and runs the firmware's IRQ
+// handler, so transactions go through the unmodified i2c_slave.c code.
+
+/**
+ * Master write: START (or repeated START), address + W, then the bytes.
+ * The first byte is the register address.
+ *
+ * @param data Bytes to send
+ * @param len Number of bytes
+ */
+void i2c_bus_write(const uint8_t *data, size_t len);
+
+/**
+ * Master read: repeated START, address + R, len bytes, NACK on the last.
+ *
+ * @param data Output buffer
+ * @param len Number of bytes to read
+ * @return false if the slave left the bus stretched (no data provided)
+ */
+bool i2c_bus_read(uint8_t *data, size_t len);
+
+/**
+ * STOP condition.
+ */
+void i2c_bus_stop(void);
+
+/**
+ * Level of an emulated GPIO output (e.g. the active-low interrupt line).
+ *
+ * @param gpio GPIO number
+ * @return Current output level
+ */
+bool i2c_bus_gpio_level(unsigned gpio);
+
+/**
+ * Number of I2C interrupts taken since start (ISR cost metric).
+ *
+ * @return Interrupt count
+ */
+uint32_t i2c_bus_irq_count(void);
+
+#endif  // I2C_BUS_H
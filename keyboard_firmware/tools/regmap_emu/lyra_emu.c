@@ -0,0 +1,332 @@
+// Host-side emulator of the keyboard's I2C register map.
+//
+//   lyra-emu                 Script mode: commands from stdin, see usage()
+//   lyra-emu load [options]  Load test of the driver's drain policy
+//
+// The register map, event bus, modifier manager, digital mouse and
+// typematic are the firmware sources compiled for the host, and every
+// register access goes through the firmware's I2C interrupt handler.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "event_bus.h"
+#include "fn_keys.h"
+#include "i2c_bus.h"
+#include "i2c_slave.h"
+#include "regmap_emu.h"
+
+// Driver defaults (lyra_i2c_keyboard.c)
+#define DRIVER_POLL_INTERVAL_MS 10
+#define DRIVER_FIFO_MAX_READ    16
+
+// Keys the load generator types on: letter/digit keys only, so modifiers,
+// the mouse button and the mouse direction keys stay idle
+static const uint8_t load_keys[] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 17, 19,
+    21, 22, 23, 24, 26, 28, 32, 35, 36, 38, 39, 40, 42, 43, 44, 45, 46, 47
+};
+#define LOAD_KEY_COUNT (sizeof(load_keys) / sizeof(load_keys[0]))
+
+// FN9 (mouse up), held for the whole run with --mouse
+#define MOUSE_KEY (FN_KEY_CODE_BASE + FN_KEY_FN9)
+
+typedef struct {
+    uint32_t rate;          // Events per second (press + release)
+    uint32_t poll_ms;       // Driver poll interval
+    uint32_t seconds;       // Run time
+    uint32_t max_read;      // Events drained per poll
+    bool frames;            // Drain with event frames instead of FIFO pops
+    bool irq;               // Poll on the interrupt line instead of a timer
+    bool mouse;             // Hold a mouse direction key for the whole run
+} load_options_t;
+
+typedef struct {
+    uint32_t injected;
+    uint32_t delivered;
+    uint32_t dropped;
+    uint32_t transactions;
+    uint32_t polls;
+    uint64_t latency_sum_ms;
+    uint32_t latency_max_ms;
+    uint32_t mouse_reads;
+    uint32_t mouse_moved;   // Sum of |x| + |y| read by the driver
+} load_stats_t;
+
+// Publish times of events still queued in the device, oldest first
+#define PENDING_SIZE 256
+static uint32_t pending_time[PENDING_SIZE];
+static uint32_t pending_head = 0;
+static uint32_t pending_tail = 0;
+
+static uint32_t lcg_state = 1;
+
+static uint32_t lcg_next(void) {
+    lcg_state = lcg_state * 1103515245u + 12345u;
+    return lcg_state >> 8;
+}
+
+static uint32_t get_le32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void deliver(load_stats_t *stats, uint8_t event) {
+    if (event_bus_decode_type(event) == KEY_EVENT_HOLD) {
+        return;  // Typematic repeats are not injected, so not timed
+    }
+    if (pending_head == pending_tail) {
+        return;
+    }
+    uint32_t latency = regmap_emu_now_ms() - pending_time[pending_head % PENDING_SIZE];
+    pending_head++;
+    stats->delivered++;
+    stats->latency_sum_ms += latency;
+    if (latency > stats->latency_max_ms) {
+        stats->latency_max_ms = latency;
+    }
+}
+
+// One run of lyra_kbd_poll_work(); returns true if the driver would re-poll at once
+static bool driver_poll(const load_options_t *options, load_stats_t *stats) {
+    uint8_t int_status;
+    regmap_emu_read(I2C_REG_INTERRUPT, &int_status, 1);
+    stats->transactions++;
+    stats->polls++;
+
+    if (int_status & (I2C_INT_KEY_EVENT | I2C_INT_FIFO_WATERMARK)) {
+        if (options->frames) {
+            for (uint32_t n = 0; n < options->max_read / I2C_FRAME_MAX_EVENTS; n++) {
+                uint8_t frame[I2C_FRAME_SIZE];
+                regmap_emu_read(I2C_REG_EVENT_FRAME, frame, I2C_FRAME_SIZE);
+                stats->transactions++;
+                for (uint8_t i = 0; i < frame[1] && i < I2C_FRAME_MAX_EVENTS; i++) {
+                    deliver(stats, frame[2 + i]);
+                }
+                if (frame[1] < I2C_FRAME_MAX_EVENTS) {
+                    break;
+                }
+            }
+        } else {
+            for (uint32_t n = 0; n < options->max_read; n++) {
+                uint8_t event;
+                regmap_emu_read(I2C_REG_FIFO_ACCESS, &event, 1);
+                stats->transactions++;
+                if (event == EVENT_BUS_NO_EVENT) {
+                    break;
+                }
+                deliver(stats, event);
+            }
+        }
+    }
+
+    if (int_status & (I2C_INT_SHIFT_MOD | I2C_INT_ALT_MOD | I2C_INT_FN_MOD)) {
+        uint8_t key_status;
+        regmap_emu_read(I2C_REG_KEY_STATUS, &key_status, 1);
+        stats->transactions++;
+    }
+    if (int_status & I2C_INT_MOUSE_EVENT) {
+        uint8_t mouse[2];
+        regmap_emu_read(I2C_REG_MOUSE_X, &mouse[0], 1);
+        regmap_emu_read(I2C_REG_MOUSE_Y, &mouse[1], 1);
+        stats->transactions += 2;
+        stats->mouse_reads++;
+        stats->mouse_moved += (uint32_t)abs((int8_t)mouse[0]) + (uint32_t)abs((int8_t)mouse[1]);
+    }
+
+    return (int_status & I2C_INT_FIFO_WATERMARK) != 0;
+}
+
+static int run_load(const load_options_t *options) {
+    load_stats_t stats = { 0 };
+    uint32_t duration_ms = options->seconds * 1000u;
+    uint32_t next_poll_ms = options->poll_ms;
+    uint64_t credit = 0;  // Event budget in 1/1000 events
+    uint8_t held_key = 0;
+    bool key_down = false;
+
+    regmap_emu_init();
+    uint32_t irq_base = i2c_bus_irq_count();
+    if (options->mouse) {
+        regmap_emu_key(MOUSE_KEY, true);
+    }
+
+    while (regmap_emu_now_ms() < duration_ms) {
+        // Inject this millisecond's share of events
+        credit += options->rate;
+        while (credit >= 1000) {
+            credit -= 1000;
+            if (!key_down) {
+                held_key = load_keys[lcg_next() % LOAD_KEY_COUNT];
+            }
+            key_down = !key_down;
+            stats.injected++;
+            if (regmap_emu_key(held_key, key_down)) {
+                pending_time[pending_tail % PENDING_SIZE] = regmap_emu_now_ms();
+                pending_tail++;
+            } else {
+                stats.dropped++;
+            }
+        }
+
+        regmap_emu_tick();
+
+        bool poll = options->irq ? regmap_emu_irq_asserted()
+                                 : regmap_emu_now_ms() >= next_poll_ms;
+        if (poll) {
+            bool again = driver_poll(options, &stats);
+            next_poll_ms = regmap_emu_now_ms() + (again ? 1 : options->poll_ms);
+        }
+    }
+
+    uint8_t telemetry[I2C_REG_TELEMETRY_SIZE];
+    regmap_emu_read(I2C_REG_TELEMETRY_BASE, telemetry, sizeof(telemetry));
+
+    uint32_t irqs = i2c_bus_irq_count() - irq_base;
+    printf("mode          %s, %s\n", options->frames ? "frames" : "fifo",
+           options->irq ? "irq-driven" : "polled");
+    printf("rate          %u events/s for %u s\n", options->rate, options->seconds);
+    printf("poll          %u ms, %u events per poll\n", options->poll_ms, options->max_read);
+    printf("injected      %u\n", stats.injected);
+    printf("delivered     %u\n", stats.delivered);
+    printf("dropped       %u (telemetry: matrix %u, fn %u)\n", stats.dropped,
+           get_le32(&telemetry[I2C_TELEMETRY_DROPS_MATRIX]),
+           get_le32(&telemetry[I2C_TELEMETRY_DROPS_FN]));
+    printf("fifo level    %u of %u, peak %u\n", telemetry[I2C_TELEMETRY_FIFO_LEVEL],
+           telemetry[I2C_TELEMETRY_FIFO_SIZE], telemetry[I2C_TELEMETRY_FIFO_PEAK]);
+    printf("latency       mean %.2f ms, max %u ms\n",
+           stats.delivered ? (double)stats.latency_sum_ms / stats.delivered : 0.0,
+           stats.latency_max_ms);
+    printf("bus           %u polls, %u transactions, %u slave interrupts\n",
+           stats.polls, stats.transactions, irqs);
+    if (options->mouse) {
+        printf("mouse         %u reads, %u counts moved\n", stats.mouse_reads, stats.mouse_moved);
+    }
+
+    return stats.dropped ? 1 : 0;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: lyra-emu                  script mode, commands on stdin:\n"
+            "         press <key> | release <key> | tap <key>\n"
+            "         tick [ms]                advance device time (default 1)\n"
+            "         read <reg> [len]         print register bytes\n"
+            "         write <reg> <byte>...    write registers\n"
+            "         irq                      print interrupt line (1 = asserted)\n"
+            "       lyra-emu load [--rate N] [--poll MS] [--seconds S] [--max-read N]\n"
+            "                     [--frames] [--irq] [--mouse] [--seed N]\n");
+}
+
+static int run_script(void) {
+    char line[256];
+
+    regmap_emu_init();
+
+    while (fgets(line, sizeof(line), stdin) != NULL) {
+        char *cmd = strtok(line, " \t\r\n");
+        if (cmd == NULL || cmd[0] == '#') {
+            continue;
+        }
+
+        char *arg = strtok(NULL, " \t\r\n");
+        unsigned long value = arg ? strtoul(arg, NULL, 0) : 0;
+
+        if (strcmp(cmd, "press") == 0 || strcmp(cmd, "release") == 0) {
+            if (!regmap_emu_key((uint8_t)value, cmd[0] == 'p')) {
+                printf("dropped\n");
+            }
+        } else if (strcmp(cmd, "tap") == 0) {
+            regmap_emu_key((uint8_t)value, true);
+            regmap_emu_tick();
+            regmap_emu_key((uint8_t)value, false);
+        } else if (strcmp(cmd, "tick") == 0) {
+            for (unsigned long i = 0; i < (arg ? value : 1); i++) {
+                regmap_emu_tick();
+            }
+        } else if (strcmp(cmd, "read") == 0) {
+            char *len_arg = strtok(NULL, " \t\r\n");
+            uint8_t len = len_arg ? (uint8_t)strtoul(len_arg, NULL, 0) : 1;
+            uint8_t data[255];
+            bool ok = regmap_emu_read((uint8_t)value, data, len);
+            for (uint8_t i = 0; i < len; i++) {
+                printf("%s%02x", i ? " " : "", data[i]);
+            }
+            printf(ok ? "\n" : " (bus stalled)\n");
+        } else if (strcmp(cmd, "write") == 0) {
+            uint8_t data[255];
+            uint8_t len = 0;
+            char *byte_arg;
+            while ((byte_arg = strtok(NULL, " \t\r\n")) != NULL && len < sizeof(data)) {
+                data[len++] = (uint8_t)strtoul(byte_arg, NULL, 0);
+            }
+            regmap_emu_write((uint8_t)value, data, len);
+        } else if (strcmp(cmd, "irq") == 0) {
+            printf("%d\n", regmap_emu_irq_asserted() ? 1 : 0);
+        } else {
+            fprintf(stderr, "unknown command: %s\n", cmd);
+            usage();
+            return 2;
+        }
+        fflush(stdout);
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        return run_script();
+    }
+    if (strcmp(argv[1], "load") != 0) {
+        usage();
+        return 2;
+    }
+
+    load_options_t options = {
+        .rate = 1000,
+        .poll_ms = DRIVER_POLL_INTERVAL_MS,
+        .seconds = 10,
+        .max_read = DRIVER_FIFO_MAX_READ,
+        .frames = false,
+        .irq = false,
+        .mouse = false,
+    };
+
+    for (int i = 2; i < argc; i++) {
+        const char *opt = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (strcmp(opt, "--frames") == 0) {
+            options.frames = true;
+        } else if (strcmp(opt, "--irq") == 0) {
+            options.irq = true;
+        } else if (strcmp(opt, "--mouse") == 0) {
+            options.mouse = true;
+        } else if (val != NULL && strcmp(opt, "--rate") == 0) {
+            options.rate = (uint32_t)strtoul(val, NULL, 0);
+            i++;
+        } else if (val != NULL && strcmp(opt, "--poll") == 0) {
+            options.poll_ms = (uint32_t)strtoul(val, NULL, 0);
+            i++;
+        } else if (val != NULL && strcmp(opt, "--seconds") == 0) {
+            options.seconds = (uint32_t)strtoul(val, NULL, 0);
+            i++;
+        } else if (val != NULL && strcmp(opt, "--max-read") == 0) {
+            options.max_read = (uint32_t)strtoul(val, NULL, 0);
+            i++;
+        } else if (val != NULL && strcmp(opt, "--seed") == 0) {
+            lcg_state = (uint32_t)strtoul(val, NULL, 0);
+            i++;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    if (options.poll_ms == 0) {
+        options.poll_ms = 1;
+    }
+
+    return run_load(&options);
+}
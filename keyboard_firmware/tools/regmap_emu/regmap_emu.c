@@ -0,0 +1,209 @@
+#include "regmap_emu.h"
+
+#include "i2c_bus.h"
+#include "config.h"
+#include "runtime_config.h"
+#include "digital_mouse.h"
+#include "event_bus.h"
+#include "fn_keys.h"
+#include "i2c_slave.h"
+#include "matrix_scanner.h"
+#include "modifier_manager.h"
+#include "typematic.h"
+
+// Device state, mirrors the locals of main()
+static event_bus_t event_bus;
+static modifier_manager_t modifier_manager;
+static digital_mouse_t digital_mouse;
+static typematic_t typematic;
+static runtime_config_t config;
+static runtime_config_t config_staging;
+static uint32_t now_ms = 0;
+static uint8_t prev_modifier_mask = 0;
+static bool had_key_event = false;
+static bool had_mouse_event = false;
+
+static void apply_runtime_config(void) {
+    modifier_manager_set_double_press_window(&modifier_manager, config.double_press_window_ms);
+    digital_mouse_set_interval(&digital_mouse, config.mouse_update_interval_ms);
+    typematic_set_params(&typematic, config.typematic_delay_ms, config.typematic_interval_ms);
+    i2c_slave_set_interrupt_moderation(config.irq_coalesce_ms,
+                                       config.mouse_update_interval_ms * IRQ_MOUSE_COALESCE_STEPS,
+                                       config.irq_watermark, config.irq_immediate_mask);
+    event_bus_set_watermark(&event_bus, config.fifo_watermark);
+}
+
+static void process_config_command(uint8_t command) {
+    uint8_t status = I2C_CONFIG_STATUS_OK;
+
+    switch (command) {
+        case I2C_CONFIG_CMD_APPLY:
+        case I2C_CONFIG_CMD_COMMIT:
+            if (!runtime_config_validate(&config_staging)) {
+                status = I2C_CONFIG_STATUS_ERR_INVALID;
+                break;
+            }
+            config = config_staging;
+            apply_runtime_config();
+            if (command == I2C_CONFIG_CMD_COMMIT && !runtime_config_save(&config)) {
+                status = I2C_CONFIG_STATUS_ERR_FLASH;
+            }
+            break;
+        case I2C_CONFIG_CMD_REVERT:
+            config_staging = config;
+            break;
+        case I2C_CONFIG_CMD_DEFAULTS:
+            runtime_config_defaults(&config_staging);
+            break;
+        default:
+            status = I2C_CONFIG_STATUS_ERR_INVALID;
+            break;
+    }
+
+    i2c_slave_set_config_status(status);
+}
+
+// Same routing as route_input_event() in main.c
+static bool route_input_event(void *ctx, const key_event_t *event) {
+    (void)ctx;
+
+    if (event->source == EVENT_SOURCE_FN) {
+        uint8_t fn_index = event->key_code - FN_KEY_CODE_BASE;
+
+        if (fn_index >= FN_KEY_FN9 && fn_index <= FN_KEY_FN12) {
+            bool pressed = (event->type == KEY_EVENT_PRESS || event->type == KEY_EVENT_HOLD);
+            digital_mouse_update_button(&digital_mouse, fn_index, pressed);
+            had_mouse_event = true;
+            return false;
+        }
+
+        if (event->type == KEY_EVENT_PRESS) {
+            modifier_manager_on_other_key_press(&modifier_manager);
+            typematic_key_down(&typematic, event->key_code, event->source, event->time_ms);
+        }
+    } else {
+        bool is_modifier = false;
+
+        if (event->type == KEY_EVENT_PRESS) {
+            is_modifier = modifier_manager_on_key_press(&modifier_manager, event->key_code,
+                                                        event->time_ms);
+        } else if (event->type == KEY_EVENT_RELEASE) {
+            is_modifier = modifier_manager_on_key_release(&modifier_manager, event->key_code,
+                                                          event->time_ms);
+        }
+
+        if (!is_modifier && event->type == KEY_EVENT_PRESS) {
+            modifier_manager_on_other_key_press(&modifier_manager);
+            typematic_key_down(&typematic, event->key_code, event->source, event->time_ms);
+        }
+    }
+
+    if (event->type == KEY_EVENT_RELEASE) {
+        typematic_key_up(&typematic, event->key_code);
+    }
+
+    had_key_event = true;
+    return true;
+}
+
+void regmap_emu_init(void) {
+    now_ms = 0;
+    prev_modifier_mask = 0;
+
+    i2c_slave_init(CONFIG_I2C_SLAVE_ADDRESS, CONFIG_I2C_INTERRUPT_GPIO);
+
+    runtime_config_load(&config);
+    config_staging = config;
+    i2c_slave_set_config_page((uint8_t *)&config_staging, sizeof(config_staging));
+
+    event_bus_init(&event_bus);
+    i2c_slave_set_event_bus(&event_bus);
+
+    modifier_manager_init(&modifier_manager,
+                          matrix_get_key_code(MODIFIER_FN_ROW, MODIFIER_FN_COL),
+                          matrix_get_key_code(MODIFIER_ALT_ROW, MODIFIER_ALT_COL),
+                          matrix_get_key_code(MODIFIER_SHIFT_ROW, MODIFIER_SHIFT_COL),
+                          config.double_press_window_ms);
+    digital_mouse_init(&digital_mouse, config.mouse_update_interval_ms);
+    typematic_init(&typematic, config.typematic_delay_ms, config.typematic_interval_ms, &event_bus);
+    event_bus_set_filter(&event_bus, route_input_event, NULL);
+
+    apply_runtime_config();
+}
+
+bool regmap_emu_key(uint8_t key_code, bool pressed) {
+    uint8_t source = (key_code >= FN_KEY_CODE_BASE) ? EVENT_SOURCE_FN : EVENT_SOURCE_MATRIX;
+    return event_bus_publish(&event_bus, source, pressed ? KEY_EVENT_PRESS : KEY_EVENT_RELEASE,
+                             key_code, now_ms);
+}
+
+void regmap_emu_tick(void) {
+    now_ms++;
+
+    typematic_tick(&typematic, now_ms);
+    if (had_key_event) {
+        i2c_slave_set_interrupt_flags(I2C_INT_KEY_EVENT);
+    }
+
+    digital_mouse_tick(&digital_mouse, now_ms);
+
+    uint8_t modifier_mask = modifier_manager_get_active_mask(&modifier_manager);
+    i2c_slave_update_modifiers(modifier_mask);
+    if (modifier_mask != prev_modifier_mask) {
+        uint8_t changed = modifier_mask ^ prev_modifier_mask;
+        if (changed & 0x01) i2c_slave_set_interrupt_flags(I2C_INT_FN_MOD);
+        if (changed & 0x02) i2c_slave_set_interrupt_flags(I2C_INT_ALT_MOD);
+        if (changed & 0x04) i2c_slave_set_interrupt_flags(I2C_INT_SHIFT_MOD);
+        prev_modifier_mask = modifier_mask;
+    }
+
+    int8_t mouse_x = digital_mouse_get_and_clear_x(&digital_mouse);
+    int8_t mouse_y = digital_mouse_get_and_clear_y(&digital_mouse);
+    i2c_slave_update_mouse(mouse_x, mouse_y);
+    if (had_mouse_event || mouse_x != 0 || mouse_y != 0) {
+        i2c_slave_set_interrupt_flags(I2C_INT_MOUSE_EVENT);
+    }
+
+    if (event_bus_check_and_clear_overflow(&event_bus)) {
+        i2c_slave_set_interrupt_flags(I2C_INT_FIFO_OVERFLOW);
+    }
+    if (event_bus_check_and_clear_watermark(&event_bus)) {
+        i2c_slave_set_interrupt_flags(I2C_INT_FIFO_WATERMARK);
+    }
+
+    i2c_slave_service_interrupt(now_ms);
+
+    uint8_t command = i2c_slave_take_config_command();
+    if (command != I2C_CONFIG_CMD_NONE) {
+        process_config_command(command);
+    }
+
+    // Events injected before the next tick count towards it
+    had_key_event = false;
+    had_mouse_event = false;
+}
+
+uint32_t regmap_emu_now_ms(void) {
+    return now_ms;
+}
+
+bool regmap_emu_irq_asserted(void) {
+    return !i2c_bus_gpio_level(CONFIG_I2C_INTERRUPT_GPIO);
+}
+
+void regmap_emu_write(uint8_t reg, const uint8_t *data, uint8_t len) {
+    uint8_t buffer[1 + 255];
+    buffer[0] = reg;
+    for (uint8_t i = 0; i < len; i++) {
+        buffer[1 + i] = data[i];
+    }
+    i2c_bus_write(buffer, 1u + len);
+    i2c_bus_stop();
+}
+
+bool regmap_emu_read(uint8_t reg, uint8_t *data, uint8_t len) {
+    i2c_bus_write(&reg, 1);
+    bool ok = i2c_bus_read(data, len);
+    i2c_bus_stop();
+    return ok;
+}
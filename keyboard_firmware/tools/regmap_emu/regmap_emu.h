@@ -0,0 +1,66 @@
+#ifndef REGMAP_EMU_H
+#define REGMAP_EMU_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Device side of the emulator: runs the firmware's event bus, modifier
+// manager, digital mouse, typematic and I2C register map on the host, with
+// the same per-tick bookkeeping as the main loop. Key input is injected
+// instead of scanned.
+
+/**
+ * Reset the emulated device (fresh boot, flash contents are kept).
+ */
+void regmap_emu_init(void);
+
+/**
+ * Inject a key transition as the matrix scanner or FN keys would publish it.
+ * Key codes follow keyboard_layout.json (0-41 matrix, 42-52 FN keys).
+ *
+ * @param key_code Global key code
+ * @param pressed true for press, false for release
+ * @return false if the event was dropped because the FIFO is full
+ */
+bool regmap_emu_key(uint8_t key_code, bool pressed);
+
+/**
+ * Advance the device by one 1 ms tick.
+ */
+void regmap_emu_tick(void);
+
+/**
+ * Current device time.
+ *
+ * @return Milliseconds since regmap_emu_init()
+ */
+uint32_t regmap_emu_now_ms(void);
+
+/**
+ * State of the active-low interrupt line.
+ *
+ * @return true while the line is asserted (low)
+ */
+bool regmap_emu_irq_asserted(void);
+
+/**
+ * Register write as the host driver issues it: [reg][data...] then STOP.
+ *
+ * @param reg First register
+ * @param data Bytes to write
+ * @param len Number of bytes
+ */
+void regmap_emu_write(uint8_t reg, const uint8_t *data, uint8_t len);
+
+/**
+ * Register read as the host driver issues it: [reg], repeated START,
+ * len bytes, STOP.
+ *
+ * @param reg First register
+ * @param data Output buffer
+ * @param len Number of bytes
+ * @return false if the slave failed to provide data
+ */
+bool regmap_emu_read(uint8_t reg, uint8_t *data, uint8_t len);
+
+#endif  // REGMAP_EMU_H
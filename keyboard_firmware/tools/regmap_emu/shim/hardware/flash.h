@@ -0,0 +1,17 @@
+#ifndef SHIM_HARDWARE_FLASH_H
+#define SHIM_HARDWARE_FLASH_H
+
+#include "pico/types.h"
+
+#define FLASH_PAGE_SIZE   256u
+#define FLASH_SECTOR_SIZE 4096u
+
+// Only the sectors used by flash_store are emulated, in RAM
+#define PICO_FLASH_SIZE_BYTES (2u * FLASH_SECTOR_SIZE)
+extern uint8_t emu_flash[PICO_FLASH_SIZE_BYTES];
+#define XIP_BASE ((uintptr_t)emu_flash)
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
+
+#endif  // SHIM_HARDWARE_FLASH_H
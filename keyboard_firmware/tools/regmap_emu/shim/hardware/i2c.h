@@ -0,0 +1,51 @@
+#ifndef SHIM_HARDWARE_I2C_H
+#define SHIM_HARDWARE_I2C_H
+
+#include "pico/types.h"
+
+// Register block of the DW_apb_i2c peripheral (fields used by the firmware)
+typedef struct {
+    volatile uint32_t con;
+    volatile uint32_t sar;
+    volatile uint32_t data_cmd;
+    volatile uint32_t intr_stat;
+    volatile uint32_t intr_mask;
+    volatile uint32_t clr_rd_req;
+    volatile uint32_t clr_tx_abrt;
+    volatile uint32_t clr_stop_det;
+    volatile uint32_t enable;
+    volatile uint32_t txflr;
+    volatile uint32_t rxflr;
+    volatile uint32_t dma_cr;
+    volatile uint32_t dma_tdlr;
+} i2c_hw_t;
+
+typedef struct {
+    i2c_hw_t *hw;
+} i2c_inst_t;
+
+extern i2c_inst_t i2c0_inst;
+#define i2c0 (&i2c0_inst)
+
+#define I2C_IC_CON_MASTER_MODE_BITS          0x00000001u
+#define I2C_IC_CON_IC_RESTART_EN_BITS        0x00000020u
+#define I2C_IC_CON_IC_SLAVE_DISABLE_BITS     0x00000040u
+#define I2C_IC_CON_TX_EMPTY_CTRL_BITS        0x00000100u
+
+#define I2C_IC_INTR_STAT_R_RX_FULL_BITS      0x00000004u
+#define I2C_IC_INTR_STAT_R_RD_REQ_BITS       0x00000020u
+#define I2C_IC_INTR_STAT_R_TX_ABRT_BITS      0x00000040u
+#define I2C_IC_INTR_STAT_R_STOP_DET_BITS     0x00000200u
+
+#define I2C_IC_INTR_MASK_M_RX_FULL_BITS      0x00000004u
+#define I2C_IC_INTR_MASK_M_RD_REQ_BITS       0x00000020u
+#define I2C_IC_INTR_MASK_M_TX_ABRT_BITS      0x00000040u
+#define I2C_IC_INTR_MASK_M_STOP_DET_BITS     0x00000200u
+
+#define I2C_IC_DATA_CMD_FIRST_DATA_BYTE_BITS 0x00000800u
+#define I2C_IC_DMA_CR_TDMAE_BITS             0x00000002u
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+uint i2c_get_dreq(i2c_inst_t *i2c, bool is_tx);
+
+#endif  // SHIM_HARDWARE_I2C_H
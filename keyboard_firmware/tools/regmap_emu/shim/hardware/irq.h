@@ -0,0 +1,13 @@
+#ifndef SHIM_HARDWARE_IRQ_H
+#define SHIM_HARDWARE_IRQ_H
+
+#include "pico/types.h"
+
+#define I2C0_IRQ 23
+
+typedef void (*irq_handler_t)(void);
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
+
+#endif  // SHIM_HARDWARE_IRQ_H
@@ -0,0 +1,9 @@
+#ifndef SHIM_PICO_STDLIB_H
+#define SHIM_PICO_STDLIB_H
+
+#include "pico/types.h"
+#include "hardware/gpio.h"
+
+static inline void tight_loop_contents(void) {}
+
+#endif  // SHIM_PICO_STDLIB_H
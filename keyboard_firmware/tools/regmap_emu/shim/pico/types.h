@@ -0,0 +1,12 @@
+#ifndef SHIM_PICO_TYPES_H
+#define SHIM_PICO_TYPES_H
+
+// Host build of the Pico SDK types used by the firmware sources
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef unsigned int uint;
+
+#endif  // SHIM_PICO_TYPES_H